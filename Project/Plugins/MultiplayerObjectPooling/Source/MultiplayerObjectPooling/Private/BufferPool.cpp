@@ -0,0 +1,202 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "BufferPool.h"
+#include "Containers/LockFreeFixedSizeAllocator.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Math/UnrealMathUtility.h"
+
+namespace BufferPool
+{
+	// The counters of every size class are on their own cache line, the threads shouldn't contend on the neighbours
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FCounters {
+		FThreadSafeCounter NumberOfUsedBlocks;
+		FThreadSafeCounter HighWaterMark;
+		FThreadSafeCounter Allocations;
+	};
+
+	// The last entry counts the allocations which are too large for the pool
+	static FCounters Counters[FPoolBufferAllocator::NumberOfSizeClasses + 1];
+
+	template<int32 BlockSize>
+	using TSizeClassAllocator = TLockFreeFixedSizeAllocator_TLSCache<BlockSize, PLATFORM_CACHE_LINE_SIZE>;
+
+	static TSizeClassAllocator<64> Allocator64;
+	static TSizeClassAllocator<128> Allocator128;
+	static TSizeClassAllocator<256> Allocator256;
+	static TSizeClassAllocator<512> Allocator512;
+	static TSizeClassAllocator<1024> Allocator1K;
+	static TSizeClassAllocator<2048> Allocator2K;
+	static TSizeClassAllocator<4096> Allocator4K;
+	static TSizeClassAllocator<8192> Allocator8K;
+	static TSizeClassAllocator<16384> Allocator16K;
+	static TSizeClassAllocator<32768> Allocator32K;
+
+	static void CountAllocation(int32 SizeClass) {
+		FCounters& SizeClassCounters = Counters[SizeClass];
+		SizeClassCounters.Allocations.Increment();
+		const int32 NumberOfUsedBlocks = SizeClassCounters.NumberOfUsedBlocks.Increment();
+
+		// Raise the high water mark without a lock, another thread might have raised it in the meantime
+		int32 HighWaterMark = SizeClassCounters.HighWaterMark.GetValue();
+		while (NumberOfUsedBlocks > HighWaterMark) {
+			const int32 PreviousHighWaterMark = SizeClassCounters.HighWaterMark.CompareExchange(HighWaterMark, NumberOfUsedBlocks);
+			if (PreviousHighWaterMark == HighWaterMark) break;
+			HighWaterMark = PreviousHighWaterMark;
+		}
+	}
+}
+
+int32 FPoolBufferAllocator::GetSizeClass(int32 Size) {
+	if (Size > MaxBlockSize) return INDEX_NONE;
+	if (Size <= MinBlockSize) return 0;
+
+	return FMath::CeilLogTwo(Size) - FMath::CeilLogTwo(MinBlockSize);
+}
+
+int32 FPoolBufferAllocator::GetBlockSize(int32 Size) {
+	const int32 SizeClass = GetSizeClass(Size);
+	return SizeClass != INDEX_NONE ? MinBlockSize << SizeClass : Size;
+}
+
+void* FPoolBufferAllocator::Allocate(int32 Size) {
+	const int32 SizeClass = GetSizeClass(Size);
+	BufferPool::CountAllocation(SizeClass != INDEX_NONE ? SizeClass : NumberOfSizeClasses);
+
+	switch (SizeClass) {
+	case 0: return BufferPool::Allocator64.Allocate();
+	case 1: return BufferPool::Allocator128.Allocate();
+	case 2: return BufferPool::Allocator256.Allocate();
+	case 3: return BufferPool::Allocator512.Allocate();
+	case 4: return BufferPool::Allocator1K.Allocate();
+	case 5: return BufferPool::Allocator2K.Allocate();
+	case 6: return BufferPool::Allocator4K.Allocate();
+	case 7: return BufferPool::Allocator8K.Allocate();
+	case 8: return BufferPool::Allocator16K.Allocate();
+	case 9: return BufferPool::Allocator32K.Allocate();
+	default: return FMemory::Malloc(Size, Alignment);
+	}
+}
+
+void FPoolBufferAllocator::Free(void* Block, int32 Size) {
+	if (Block == nullptr) return;
+
+	const int32 SizeClass = GetSizeClass(Size);
+	BufferPool::Counters[SizeClass != INDEX_NONE ? SizeClass : NumberOfSizeClasses].NumberOfUsedBlocks.Decrement();
+
+	switch (SizeClass) {
+	case 0: BufferPool::Allocator64.Free(Block); break;
+	case 1: BufferPool::Allocator128.Free(Block); break;
+	case 2: BufferPool::Allocator256.Free(Block); break;
+	case 3: BufferPool::Allocator512.Free(Block); break;
+	case 4: BufferPool::Allocator1K.Free(Block); break;
+	case 5: BufferPool::Allocator2K.Free(Block); break;
+	case 6: BufferPool::Allocator4K.Free(Block); break;
+	case 7: BufferPool::Allocator8K.Free(Block); break;
+	case 8: BufferPool::Allocator16K.Free(Block); break;
+	case 9: BufferPool::Allocator32K.Free(Block); break;
+	default: FMemory::Free(Block); break;
+	}
+}
+
+void FPoolBufferAllocator::GetStats(TArray<FSizeClassStats>& OutStats) {
+	OutStats.Reset(NumberOfSizeClasses + 1);
+	for (int32 SizeClass = 0; SizeClass <= NumberOfSizeClasses; SizeClass++) {
+		const BufferPool::FCounters& SizeClassCounters = BufferPool::Counters[SizeClass];
+
+		FSizeClassStats SizeClassStats;
+		SizeClassStats.BlockSize = SizeClass < NumberOfSizeClasses ? MinBlockSize << SizeClass : 0;
+		SizeClassStats.NumberOfUsedBlocks = SizeClassCounters.NumberOfUsedBlocks.GetValue();
+		SizeClassStats.HighWaterMark = SizeClassCounters.HighWaterMark.GetValue();
+		SizeClassStats.Allocations = SizeClassCounters.Allocations.GetValue();
+		OutStats.Add(SizeClassStats);
+	}
+}
+
+int32 FPoolBufferAllocator::GetNumberOfUsedBlocks() {
+	int32 NumberOfUsedBlocks = 0;
+	for (int32 SizeClass = 0; SizeClass < NumberOfSizeClasses; SizeClass++) {
+		NumberOfUsedBlocks += BufferPool::Counters[SizeClass].NumberOfUsedBlocks.GetValue();
+	}
+	return NumberOfUsedBlocks;
+}
+
+void FPoolBufferAllocator::DumpStats(FOutputDevice& Ar) {
+	TArray<FSizeClassStats> AllStats;
+	GetStats(AllStats);
+
+	Ar.Logf(TEXT("%-12s %10s %12s %12s %14s"), TEXT("BlockSize"), TEXT("InUse"), TEXT("HighWater"), TEXT("Allocations"), TEXT("HighWater(KB)"));
+	for (auto& SizeClassStats : AllStats) {
+		if (SizeClassStats.Allocations == 0) continue;
+
+		if (SizeClassStats.BlockSize > 0) {
+			Ar.Logf(TEXT("%-12d %10d %12d %12d %14d"), SizeClassStats.BlockSize, SizeClassStats.NumberOfUsedBlocks, SizeClassStats.HighWaterMark,
+				SizeClassStats.Allocations, SizeClassStats.HighWaterMark * SizeClassStats.BlockSize / 1024);
+		}
+		else {
+			Ar.Logf(TEXT("%-12s %10d %12d %12d %14s"), TEXT("Oversized"), SizeClassStats.NumberOfUsedBlocks, SizeClassStats.HighWaterMark,
+				SizeClassStats.Allocations, TEXT("-"));
+		}
+	}
+}
+
+FPooledBuffer::FPooledBuffer(FPooledBuffer&& Other)
+	: Data(Other.Data)
+	, Size(Other.Size)
+	, Capacity(Other.Capacity)
+{
+	Other.Data = nullptr;
+	Other.Size = 0;
+	Other.Capacity = 0;
+}
+
+FPooledBuffer& FPooledBuffer::operator=(FPooledBuffer&& Other) {
+	if (this != &Other) {
+		Release();
+		Data = Other.Data;
+		Size = Other.Size;
+		Capacity = Other.Capacity;
+		Other.Data = nullptr;
+		Other.Size = 0;
+		Other.Capacity = 0;
+	}
+	return *this;
+}
+
+void FPooledBuffer::Reserve(int32 NewCapacity) {
+	if (NewCapacity <= Capacity) return;
+
+	// Grow into the next size class
+	const int32 BlockSize = FPoolBufferAllocator::GetBlockSize(FMath::Max(NewCapacity, Capacity * 2));
+	uint8* NewData = (uint8*)FPoolBufferAllocator::Allocate(BlockSize);
+	if (Size > 0) {
+		FMemory::Memcpy(NewData, Data, Size);
+	}
+	if (Data != nullptr) {
+		FPoolBufferAllocator::Free(Data, Capacity);
+	}
+	Data = NewData;
+	Capacity = BlockSize;
+}
+
+void FPooledBuffer::SetNumUninitialized(int32 NewSize) {
+	check(NewSize >= 0);
+	Reserve(NewSize);
+	Size = NewSize;
+}
+
+void FPooledBuffer::Append(const void* Source, int32 Count) {
+	if (Count <= 0) return;
+
+	Reserve(Size + Count);
+	FMemory::Memcpy(Data + Size, Source, Count);
+	Size += Count;
+}
+
+void FPooledBuffer::Release() {
+	if (Data != nullptr) {
+		FPoolBufferAllocator::Free(Data, Capacity);
+		Data = nullptr;
+	}
+	Size = 0;
+	Capacity = 0;
+}
@@ -0,0 +1,29 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "ObjectPool.h"
+
+TArray<FObjectPoolBase*> FObjectPoolBase::RegisteredPools;
+
+FObjectPoolBase::FObjectPoolBase(UClass* InClass)
+	: Class(InClass)
+{
+	check(IsInGameThread());
+	RegisteredPools.Add(this);
+
+#if CSV_PROFILER
+	CsvStatNameInUse = FName(*FString::Printf(TEXT("%s_Native_InUse"), *Class->GetName()));
+	CsvStatNameAvailable = FName(*FString::Printf(TEXT("%s_Native_Available"), *Class->GetName()));
+#endif
+}
+
+FObjectPoolBase::~FObjectPoolBase() {
+	check(IsInGameThread());
+	RegisteredPools.RemoveSingleSwap(this, false);
+}
+
+void FObjectPoolBase::PublishStats() const {
+#if CSV_PROFILER
+	FCsvProfiler::RecordCustomStat(CsvStatNameInUse, CSV_CATEGORY_INDEX(ObjectPool), GetNumberOfUsedObjects(), ECsvCustomStatOp::Set);
+	FCsvProfiler::RecordCustomStat(CsvStatNameAvailable, CSV_CATEGORY_INDEX(ObjectPool), GetNumberOfAvailableObjects(), ECsvCustomStatOp::Set);
+#endif
+}
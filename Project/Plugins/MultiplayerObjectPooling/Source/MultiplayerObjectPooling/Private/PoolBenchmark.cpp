@@ -0,0 +1,544 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "PoolBenchmark.h"
+#include "Engine.h"
+#include "PoolManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+
+APoolBenchmarkActor::APoolBenchmarkActor() {
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
+	Child = CreateDefaultSubobject<USceneComponent>(TEXT("Child"));
+	Child->SetupAttachment(RootComponent);
+}
+
+APoolBenchmarkMover::APoolBenchmarkMover() {
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
+}
+
+void APoolBenchmarkMover::Tick(float DeltaSeconds) {
+	Super::Tick(DeltaSeconds);
+
+	Velocity.Z += GetWorld()->GetGravityZ() * DeltaSeconds;
+	SetActorLocation(GetActorLocation() + Velocity * DeltaSeconds);
+}
+
+void APoolBenchmarkMover::PoolableBeginPlay_Implementation() {}
+
+void APoolBenchmarkMover::PoolableEndPlay_Implementation() {}
+
+void APoolBenchmarkMover::PoolableBeginUpdate(FVector& OutVelocity, float& RemainingLifeSpan) {
+	OutVelocity = Velocity;
+}
+
+void APoolBenchmarkMover::PoolableUpdate(float DeltaSeconds, FVector& Location, FVector& OutVelocity, float& RemainingLifeSpan) {
+	OutVelocity.Z += GetWorld()->GetGravityZ() * DeltaSeconds;
+}
+
+FString FPoolBenchmark::Run(const TArray<int32>& Sizes, int32 Rounds) {
+	Results.Empty();
+	TickResults.Empty();
+	ResetChecks.Empty();
+
+	for (const int32 Size : Sizes) {
+		RunPooled(APoolBenchmarkActor::StaticClass(), Size, Rounds);
+		RunPooled(APoolBenchmarkActor::StaticClass(), Size, Rounds, false);
+		RunBaseline(APoolBenchmarkActor::StaticClass(), Size, Rounds);
+		RunPooled(UPoolBenchmarkObject::StaticClass(), Size, Rounds);
+		RunBaseline(UPoolBenchmarkObject::StaticClass(), Size, Rounds);
+		RunTick(Size, false);
+		RunTick(Size, true);
+		RunInstances(Size * InstancesPerActor, Rounds);
+	}
+
+	RunBurst(Rounds, true);
+	RunBurst(Rounds, false);
+
+	RunResetChecks();
+
+	return ToJson();
+}
+
+void FPoolBenchmark::RunPooled(UClass* Class, int32 Size, int32 Rounds, bool bCloneFromTemplate) {
+	APoolManager* PoolManager = APoolManager::GetPoolManager(World);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	FResult Result;
+	Result.Name = bCloneFromTemplate ? TEXT("Pool") : TEXT("PoolWithoutTemplate");
+	Result.ClassName = Class->GetName();
+	Result.Size = Size;
+	Result.Rounds = Rounds;
+
+	FPoolEntry PoolEntry;
+	PoolEntry.Class = Class;
+	PoolEntry.AmountOfObjects = Size;
+	PoolEntry.bCloneFromTemplate = bCloneFromTemplate;
+
+	const uint64 UsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+	const double WarmUpStart = FPlatformTime::Seconds();
+	const FPoolHandle Handle = PoolManager->AddObjectPool(PoolEntry);
+	Result.WarmUpMilliseconds = (FPlatformTime::Seconds() - WarmUpStart) * 1000.0;
+	Result.MemoryBytes = (int64)FPlatformMemory::GetStats().UsedPhysical - (int64)UsedMemory;
+
+	FSpawnParameter SpawnParameter;
+	SpawnParameter.HandleEmptyPool = EHandleEmptyPool::IGNORE;
+
+	TArray<UObject*> Objects;
+	Objects.Reserve(Size);
+	TArray<uint64> AcquireCycles;
+	TArray<uint64> ReleaseCycles;
+	AcquireCycles.Reserve(Size * Rounds);
+	ReleaseCycles.Reserve(Size * Rounds);
+
+	for (int Round = 0; Round < Rounds; Round++) {
+		for (int i = 0; i < Size; i++) {
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Objects.Add(APoolManager::GetFromPoolByHandle(Handle, SpawnParameter));
+			AcquireCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+		}
+
+		for (auto& Object : Objects) {
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			APoolManager::ReturnToPool(Object);
+			ReleaseCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+		}
+		Objects.Reset();
+	}
+
+	Evaluate(Result, AcquireCycles, ReleaseCycles);
+	Results.Add(Result);
+
+	APoolManager::EmptyObjectPool(World, Class);
+}
+
+void FPoolBenchmark::RunBaseline(UClass* Class, int32 Size, int32 Rounds) {
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	const bool bIsActor = Class->IsChildOf(AActor::StaticClass());
+
+	FResult Result;
+	Result.Name = bIsActor ? TEXT("SpawnActor") : TEXT("NewObject");
+	Result.ClassName = Class->GetName();
+	Result.Size = Size;
+	Result.Rounds = Rounds;
+
+	TArray<UObject*> Objects;
+	Objects.Reserve(Size);
+	TArray<uint64> AcquireCycles;
+	TArray<uint64> ReleaseCycles;
+	AcquireCycles.Reserve(Size * Rounds);
+	ReleaseCycles.Reserve(Size * Rounds);
+
+	const uint64 UsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+	for (int Round = 0; Round < Rounds; Round++) {
+		for (int i = 0; i < Size; i++) {
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			if (bIsActor) {
+				Objects.Add(World->SpawnActor(Class));
+			}
+			else {
+				Objects.Add(NewObject<UObject>((UObject*)GetTransientPackage(), Class));
+			}
+			AcquireCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+		}
+
+		// The memory of the first round is comparable to the filled pool
+		if (Round == 0) {
+			Result.MemoryBytes = (int64)FPlatformMemory::GetStats().UsedPhysical - (int64)UsedMemory;
+		}
+
+		for (auto& Object : Objects) {
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			if (bIsActor) {
+				CastChecked<AActor>(Object)->Destroy();
+			}
+			else {
+				Object->MarkPendingKill();
+			}
+			ReleaseCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+		}
+		Objects.Reset();
+	}
+
+	Evaluate(Result, AcquireCycles, ReleaseCycles);
+	Results.Add(Result);
+}
+
+void FPoolBenchmark::RunTick(int32 Size, bool bBatchedUpdate) {
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	FTickResult Result;
+	Result.Name = bBatchedUpdate ? TEXT("TickBatched") : TEXT("TickPerActor");
+	Result.Size = Size;
+	Result.Frames = NumberOfTickFrames;
+
+	FPoolEntry PoolEntry;
+	PoolEntry.Class = APoolBenchmarkMover::StaticClass();
+	PoolEntry.AmountOfObjects = Size;
+	PoolEntry.bBatchedUpdate = bBatchedUpdate;
+	const FPoolHandle Handle = APoolManager::GetPoolManager(World)->AddObjectPool(PoolEntry);
+	APoolHolder* PoolHolder = APoolManager::ResolvePoolHandle(Handle);
+
+	TArray<AActor*> Actors;
+	Actors.Reserve(Size);
+	for (int i = 0; i < Size; i++) {
+		Actors.Add(APoolManager::Acquire<AActor>(Handle));
+	}
+
+	// The tick functions are executed directly, the scheduling by the tick task manager comes on top of it for every tick function
+	const float DeltaSeconds = 1.f / 60.f;
+	TArray<uint64> FrameCycles;
+	FrameCycles.Reserve(NumberOfTickFrames);
+	for (int Frame = 0; Frame < NumberOfTickFrames; Frame++) {
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		if (bBatchedUpdate) {
+			PoolHolder->PrimaryActorTick.ExecuteTick(DeltaSeconds, LEVELTICK_All, ENamedThreads::GameThread, FGraphEventRef());
+		}
+		else {
+			for (auto& Actor : Actors) {
+				Actor->PrimaryActorTick.ExecuteTick(DeltaSeconds, LEVELTICK_All, ENamedThreads::GameThread, FGraphEventRef());
+			}
+		}
+		FrameCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+	}
+
+	uint64 TotalCycles = 0;
+	for (const uint64 Cycles : FrameCycles) {
+		TotalCycles += Cycles;
+	}
+	FrameCycles.Sort();
+	Result.FrameMilliseconds = FPlatformTime::ToMilliseconds64(TotalCycles) / NumberOfTickFrames;
+	Result.FrameP99Milliseconds = GetPercentile(FrameCycles, 0.99f) / 1000.0;
+	TickResults.Add(Result);
+
+	for (auto& Actor : Actors) {
+		APoolManager::ReturnToPool(Actor);
+	}
+	APoolManager::EmptyObjectPool(World, APoolBenchmarkMover::StaticClass());
+}
+
+void FPoolBenchmark::RunBurst(int32 Rounds, bool bBatched) {
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	FResult Result;
+	Result.Name = bBatched ? TEXT("BurstBatched") : TEXT("BurstSingle");
+	Result.ClassName = APoolBenchmarkActor::StaticClass()->GetName();
+	Result.Size = BurstSize;
+	Result.Rounds = Rounds;
+
+	FPoolEntry PoolEntry;
+	PoolEntry.Class = APoolBenchmarkActor::StaticClass();
+	PoolEntry.AmountOfObjects = BurstSize;
+	APoolManager::GetPoolManager(World)->AddObjectPool(PoolEntry);
+
+	TArray<FTransform> SpawnTransforms;
+	SpawnTransforms.Reserve(BurstSize);
+	for (int i = 0; i < BurstSize; i++) {
+		SpawnTransforms.Add(FTransform(FVector(i * 100.f, 0.f, 0.f)));
+	}
+
+	TArray<AActor*> Actors;
+	Actors.Reserve(BurstSize);
+	TArray<uint64> AcquireCycles;
+	TArray<uint64> ReleaseCycles;
+	AcquireCycles.Reserve(BurstsPerRound * Rounds);
+	ReleaseCycles.Reserve(BurstsPerRound * Rounds);
+	EBranch Branch;
+
+	for (int Burst = 0; Burst < BurstsPerRound * Rounds; Burst++) {
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		if (bBatched) {
+			APoolManager::SpawnActorsFromPool(World, APoolBenchmarkActor::StaticClass(), SpawnTransforms, nullptr, nullptr, Actors, Branch, FSpawnParameter());
+		}
+		else {
+			for (auto& SpawnTransform : SpawnTransforms) {
+				Actors.Add(APoolManager::SpawnActorFromPool(World, APoolBenchmarkActor::StaticClass(), SpawnTransform, nullptr, nullptr, Branch, FSpawnParameter(), FSpecificSearch()));
+			}
+		}
+		AcquireCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+
+		const uint64 ReleaseStartCycles = FPlatformTime::Cycles64();
+		for (auto& Actor : Actors) {
+			APoolManager::ReturnToPool(Actor);
+		}
+		ReleaseCycles.Add(FPlatformTime::Cycles64() - ReleaseStartCycles);
+		Actors.Reset();
+	}
+
+	Evaluate(Result, AcquireCycles, ReleaseCycles);
+	Results.Add(Result);
+
+	APoolManager::EmptyObjectPool(World, APoolBenchmarkActor::StaticClass());
+}
+
+void FPoolBenchmark::RunInstances(int32 Size, int32 Rounds) {
+	FResult Result;
+	Result.Name = TEXT("Instances");
+	Result.ClassName = TEXT("PoolInstanceSet");
+	Result.Size = Size;
+	Result.Rounds = Rounds;
+
+	FPoolInstanceSet Instances;
+	const double WarmUpStart = FPlatformTime::Seconds();
+	Instances.Initialize(0);
+	Instances.Reserve(Size);
+	Result.WarmUpMilliseconds = (FPlatformTime::Seconds() - WarmUpStart) * 1000.0;
+	Result.MemoryBytes = Instances.GetAllocatedBytes();
+
+	TArray<FPoolInstanceHandle> Handles;
+	Handles.Reserve(Size);
+	TArray<uint64> AcquireCycles;
+	TArray<uint64> ReleaseCycles;
+	AcquireCycles.Reserve(Size * Rounds);
+	ReleaseCycles.Reserve(Size * Rounds);
+	TArray<int32> DirtyInstances;
+
+	for (int Round = 0; Round < Rounds; Round++) {
+		for (int i = 0; i < Size; i++) {
+			const FTransform Transform(FVector(i * 100.f, 0.f, 0.f));
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Handles.Add(Instances.Add(Transform));
+			AcquireCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+		}
+
+		for (auto& Handle : Handles) {
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Instances.Remove(Handle);
+			ReleaseCycles.Add(FPlatformTime::Cycles64() - StartCycles);
+		}
+		Handles.Reset();
+		Instances.ConsumeDirtyInstances(DirtyInstances);
+	}
+
+	Evaluate(Result, AcquireCycles, ReleaseCycles);
+	Results.Add(Result);
+}
+
+void FPoolBenchmark::RunResetChecks() {
+	FSpawnParameter SpawnParameter;
+	SpawnParameter.HandleEmptyPool = EHandleEmptyPool::IGNORE;
+
+	// The default settings are derived from the class default object and shared by all pools of the class
+	const TSharedRef<const FPoolClassDefaults> ClassDefaults = FPoolClassDefaultsRegistry::Get(APoolBenchmarkActor::StaticClass());
+	AddResetCheck(TEXT("ClassDefaultsShared"), &ClassDefaults.Get() == &FPoolClassDefaultsRegistry::Get(APoolBenchmarkActor::StaticClass()).Get());
+	AddResetCheck(TEXT("ClassDefaultsComponents"), ClassDefaults->ComponentsSettings.ContainsByPredicate([](const FDefaultComponentSettings& ComponentSettings) {
+		return ComponentSettings.Name == TEXT("Child") && ComponentSettings.bIsSceneComponent;
+	}));
+
+	// A pool with a single actor always hands out the same actor
+	FPoolEntry PoolEntry;
+	PoolEntry.Class = APoolBenchmarkActor::StaticClass();
+	PoolEntry.AmountOfObjects = 1;
+	const FPoolHandle ActorHandle = APoolManager::GetPoolManager(World)->AddObjectPool(PoolEntry);
+
+	APoolBenchmarkActor* Actor = APoolManager::Acquire<APoolBenchmarkActor>(ActorHandle, SpawnParameter);
+	AddResetCheck(TEXT("ActorAcquired"), Actor != nullptr);
+	if (Actor != nullptr) {
+		Actor->Counter = 42;
+		Actor->SetActorTickEnabled(false);
+		Actor->SetActorHiddenInGame(true);
+		Actor->Child->SetRelativeLocation(FVector(100.f, 0.f, 0.f));
+		Actor->Child->SetVisibility(false);
+		Actor->Child->ComponentTags.Add(TEXT("Dirty"));
+		APoolManager::ReturnToPool(Actor);
+
+		APoolBenchmarkActor* ReusedActor = APoolManager::Acquire<APoolBenchmarkActor>(ActorHandle, SpawnParameter);
+		AddResetCheck(TEXT("ActorReused"), ReusedActor == Actor);
+		AddResetCheck(TEXT("ActorGameplayProperty"), Actor->Counter == 0);
+		AddResetCheck(TEXT("ActorTickEnabled"), Actor->IsActorTickEnabled());
+		AddResetCheck(TEXT("ActorVisible"), !Actor->bHidden);
+		AddResetCheck(TEXT("ComponentRelativeTransform"), Actor->Child->RelativeLocation.IsNearlyZero());
+		AddResetCheck(TEXT("ComponentVisible"), Actor->Child->IsVisible());
+		AddResetCheck(TEXT("ComponentTags"), Actor->Child->ComponentTags.Num() == 0);
+		AddResetCheck(TEXT("ActorActive"), APoolManager::IsObjectActive(Actor));
+		APoolManager::ReturnToPool(Actor);
+		AddResetCheck(TEXT("ActorReturned"), !APoolManager::IsObjectActive(Actor));
+	}
+	APoolManager::EmptyObjectPool(World, APoolBenchmarkActor::StaticClass());
+
+	PoolEntry.Class = UPoolBenchmarkObject::StaticClass();
+	const FPoolHandle ObjectHandle = APoolManager::GetPoolManager(World)->AddObjectPool(PoolEntry);
+
+	UPoolBenchmarkObject* Object = APoolManager::Acquire<UPoolBenchmarkObject>(ObjectHandle, SpawnParameter);
+	AddResetCheck(TEXT("ObjectAcquired"), Object != nullptr);
+	if (Object != nullptr) {
+		Object->Counter = 42;
+		Object->Payload.Add(42);
+		APoolManager::ReturnToPool(Object);
+
+		UPoolBenchmarkObject* ReusedObject = APoolManager::Acquire<UPoolBenchmarkObject>(ObjectHandle, SpawnParameter);
+		AddResetCheck(TEXT("ObjectReused"), ReusedObject == Object);
+		AddResetCheck(TEXT("ObjectGameplayProperty"), Object->Counter == 0);
+		AddResetCheck(TEXT("ObjectGameplayArray"), Object->Payload.Num() == 0);
+		APoolManager::ReturnToPool(Object);
+	}
+	APoolManager::EmptyObjectPool(World, UPoolBenchmarkObject::StaticClass());
+}
+
+void FPoolBenchmark::AddResetCheck(const TCHAR* Name, bool bPassed) {
+	FResetCheck ResetCheck;
+	ResetCheck.Name = Name;
+	ResetCheck.bPassed = bPassed;
+	ResetChecks.Add(ResetCheck);
+}
+
+void FPoolBenchmark::Evaluate(FResult& Result, TArray<uint64>& AcquireCycles, TArray<uint64>& ReleaseCycles) {
+	uint64 TotalAcquireCycles = 0;
+	for (const uint64 Cycles : AcquireCycles) {
+		TotalAcquireCycles += Cycles;
+	}
+	uint64 TotalReleaseCycles = 0;
+	for (const uint64 Cycles : ReleaseCycles) {
+		TotalReleaseCycles += Cycles;
+	}
+
+	const double AcquireSeconds = FPlatformTime::ToSeconds64(TotalAcquireCycles);
+	const double ReleaseSeconds = FPlatformTime::ToSeconds64(TotalReleaseCycles);
+	Result.AcquiresPerSecond = AcquireSeconds > 0.0 ? AcquireCycles.Num() / AcquireSeconds : 0.0;
+	Result.ReleasesPerSecond = ReleaseSeconds > 0.0 ? ReleaseCycles.Num() / ReleaseSeconds : 0.0;
+
+	AcquireCycles.Sort();
+	ReleaseCycles.Sort();
+	Result.AcquireP50 = GetPercentile(AcquireCycles, 0.5f);
+	Result.AcquireP99 = GetPercentile(AcquireCycles, 0.99f);
+	Result.ReleaseP50 = GetPercentile(ReleaseCycles, 0.5f);
+	Result.ReleaseP99 = GetPercentile(ReleaseCycles, 0.99f);
+}
+
+double FPoolBenchmark::GetPercentile(const TArray<uint64>& SortedCycles, float Percentile) {
+	if (SortedCycles.Num() == 0) return 0.0;
+
+	const int32 Index = FMath::Min(FMath::FloorToInt(SortedCycles.Num() * Percentile), SortedCycles.Num() - 1);
+	return FPlatformTime::ToSeconds64(SortedCycles[Index]) * 1000000.0;
+}
+
+FString FPoolBenchmark::ToJson() const {
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+	Root->SetStringField(TEXT("configuration"), LexToString(FApp::GetBuildConfiguration()));
+	Root->SetStringField(TEXT("latencyUnit"), TEXT("us"));
+
+	TArray<TSharedPtr<FJsonValue>> ResultValues;
+	for (auto& Result : Results) {
+		TSharedRef<FJsonObject> ResultObject = MakeShared<FJsonObject>();
+		ResultObject->SetStringField(TEXT("name"), Result.Name);
+		ResultObject->SetStringField(TEXT("class"), Result.ClassName);
+		ResultObject->SetNumberField(TEXT("size"), Result.Size);
+		ResultObject->SetNumberField(TEXT("rounds"), Result.Rounds);
+		ResultObject->SetNumberField(TEXT("warmUpMs"), Result.WarmUpMilliseconds);
+		ResultObject->SetNumberField(TEXT("memoryBytes"), Result.MemoryBytes);
+		ResultObject->SetNumberField(TEXT("acquiresPerSecond"), Result.AcquiresPerSecond);
+		ResultObject->SetNumberField(TEXT("releasesPerSecond"), Result.ReleasesPerSecond);
+		ResultObject->SetNumberField(TEXT("acquireP50"), Result.AcquireP50);
+		ResultObject->SetNumberField(TEXT("acquireP99"), Result.AcquireP99);
+		ResultObject->SetNumberField(TEXT("releaseP50"), Result.ReleaseP50);
+		ResultObject->SetNumberField(TEXT("releaseP99"), Result.ReleaseP99);
+		ResultValues.Add(MakeShared<FJsonValueObject>(ResultObject));
+	}
+	Root->SetArrayField(TEXT("results"), ResultValues);
+
+	TArray<TSharedPtr<FJsonValue>> TickResultValues;
+	for (auto& TickResult : TickResults) {
+		TSharedRef<FJsonObject> TickResultObject = MakeShared<FJsonObject>();
+		TickResultObject->SetStringField(TEXT("name"), TickResult.Name);
+		TickResultObject->SetNumberField(TEXT("size"), TickResult.Size);
+		TickResultObject->SetNumberField(TEXT("frames"), TickResult.Frames);
+		TickResultObject->SetNumberField(TEXT("frameMs"), TickResult.FrameMilliseconds);
+		TickResultObject->SetNumberField(TEXT("frameP99Ms"), TickResult.FrameP99Milliseconds);
+		TickResultValues.Add(MakeShared<FJsonValueObject>(TickResultObject));
+	}
+	Root->SetArrayField(TEXT("tickResults"), TickResultValues);
+
+	bool bAllResetChecksPassed = true;
+	TArray<TSharedPtr<FJsonValue>> ResetCheckValues;
+	for (auto& ResetCheck : ResetChecks) {
+		TSharedRef<FJsonObject> ResetCheckObject = MakeShared<FJsonObject>();
+		ResetCheckObject->SetStringField(TEXT("name"), ResetCheck.Name);
+		ResetCheckObject->SetBoolField(TEXT("passed"), ResetCheck.bPassed);
+		ResetCheckValues.Add(MakeShared<FJsonValueObject>(ResetCheckObject));
+		bAllResetChecksPassed &= ResetCheck.bPassed;
+	}
+	Root->SetArrayField(TEXT("resetChecks"), ResetCheckValues);
+	Root->SetBoolField(TEXT("resetChecksPassed"), bAllResetChecksPassed);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root, Writer);
+	return Json;
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolBenchmarkCommand(
+	TEXT("Pool.Benchmark"),
+	TEXT("Measures the object pools against SpawnActor/Destroy and NewObject, the batched update against the actor ticks and checks the restore of pooled objects. ")
+	TEXT("Arguments: Sizes=10,100,1000,10000,50000 Rounds=3 Output=<file> Quit"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar) {
+		TArray<int32> Sizes = { 10, 100, 1000, 10000, 50000 };
+		int32 Rounds = 3;
+		FString OutputFile = FPaths::ProfilingDir() / TEXT("PoolBenchmark") / FString::Printf(TEXT("PoolBenchmark-%s.json"), *FDateTime::Now().ToString());
+		bool bQuit = false;
+
+		for (auto& Arg : Args) {
+			FString Value;
+			if (FParse::Value(*Arg, TEXT("Sizes="), Value)) {
+				TArray<FString> SizeStrings;
+				Value.ParseIntoArray(SizeStrings, TEXT(","));
+				Sizes.Empty();
+				for (auto& SizeString : SizeStrings) {
+					Sizes.Add(FMath::Max(FCString::Atoi(*SizeString), 1));
+				}
+			}
+			else if (FParse::Value(*Arg, TEXT("Rounds="), Value)) {
+				Rounds = FMath::Max(FCString::Atoi(*Value), 1);
+			}
+			else if (FParse::Value(*Arg, TEXT("Output="), Value)) {
+				OutputFile = Value;
+			}
+			else if (Arg == TEXT("Quit")) {
+				bQuit = true;
+			}
+		}
+
+		// The benchmark needs a pool manager, a temporary one is spawned for worlds without pools
+		APoolManager* SpawnedPoolManager = nullptr;
+		if (!IsValid(APoolManager::GetPoolManager(World)) && World != nullptr) {
+			SpawnedPoolManager = World->SpawnActor<APoolManager>();
+		}
+
+		if (World == nullptr || !IsValid(APoolManager::GetPoolManager(World))) {
+			Ar.Log(TEXT("Pool.Benchmark needs a game world."));
+		}
+		else {
+			FPoolBenchmark Benchmark(World);
+			const FString Json = Benchmark.Run(Sizes, Rounds);
+
+			if (FFileHelper::SaveStringToFile(Json, *OutputFile)) {
+				Ar.Logf(TEXT("Pool.Benchmark results written to %s"), *OutputFile);
+			}
+			else {
+				Ar.Logf(TEXT("Pool.Benchmark failed to write %s"), *OutputFile);
+			}
+		}
+
+		if (SpawnedPoolManager != nullptr) {
+			SpawnedPoolManager->Destroy();
+		}
+
+		if (bQuit) {
+			FPlatformMisc::RequestExit(false);
+		}
+	})
+);
+#endif
@@ -0,0 +1,164 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PoolableInterface.h"
+#include "PoolBenchmark.generated.h"
+
+/**
+ * Actor which is pooled by the benchmark. It has a child component to check the restore of the component settings
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class APoolBenchmarkActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	APoolBenchmarkActor();
+
+	UPROPERTY()
+		USceneComponent* Child;
+
+	// Changed by the benchmark to check the restore of the gameplay properties
+	UPROPERTY()
+		int32 Counter = 0;
+};
+
+/**
+ * Actor which falls with a velocity, either moved by its own tick or by the batched update of its pool
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class APoolBenchmarkMover : public AActor, public IPoolableInterface
+{
+	GENERATED_BODY()
+
+public:
+
+	APoolBenchmarkMover();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void PoolableBeginPlay_Implementation();
+
+	virtual void PoolableEndPlay_Implementation();
+
+	virtual void PoolableBeginUpdate(FVector& OutVelocity, float& RemainingLifeSpan) override;
+
+	virtual void PoolableUpdate(float DeltaSeconds, FVector& Location, FVector& OutVelocity, float& RemainingLifeSpan) override;
+
+	UPROPERTY()
+		FVector Velocity = FVector(100.f, 0.f, 0.f);
+};
+
+/**
+ * Object which is pooled by the benchmark
+ */
+UCLASS(NotBlueprintable, Transient)
+class UPoolBenchmarkObject : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+		int32 Counter = 0;
+
+	UPROPERTY()
+		TArray<int32> Payload;
+};
+
+/**
+ * Measures the pools against SpawnActor/Destroy and NewObject, the batched spawn of a burst against single spawns,
+ * the batched update against the actor ticks, the lightweight instances
+ * and checks the restore of the pooled objects.
+ * Run it with the console command Pool.Benchmark or the automation tests Plugins.MultiplayerObjectPooling,
+ * the results are written as json to the profiling directory.
+ */
+class FPoolBenchmark
+{
+public:
+
+	struct FResult {
+		FString Name;
+		FString ClassName;
+		int32 Size = 0;
+		int32 Rounds = 0;
+		double WarmUpMilliseconds = 0.0;
+		int64 MemoryBytes = 0;
+		double AcquiresPerSecond = 0.0;
+		double ReleasesPerSecond = 0.0;
+		double AcquireP50 = 0.0;
+		double AcquireP99 = 0.0;
+		double ReleaseP50 = 0.0;
+		double ReleaseP99 = 0.0;
+	};
+
+	// The time of the frames in which the active objects of a pool have been updated
+	struct FTickResult {
+		FString Name;
+		int32 Size = 0;
+		int32 Frames = 0;
+		double FrameMilliseconds = 0.0;
+		double FrameP99Milliseconds = 0.0;
+	};
+
+	struct FResetCheck {
+		FString Name;
+		bool bPassed = false;
+	};
+
+	FPoolBenchmark(UWorld* InWorld) : World(InWorld) {}
+
+	// Run all benchmarks for the pool sizes and return the results as json
+	FString Run(const TArray<int32>& Sizes, int32 Rounds);
+
+	// Check the restore of pooled actors and objects, the world needs a pool manager
+	void RunResetChecks();
+
+	const TArray<FResetCheck>& GetResetChecks() const { return ResetChecks; }
+
+private:
+
+	UWorld* World;
+
+	TArray<FResult> Results;
+
+	TArray<FTickResult> TickResults;
+
+	TArray<FResetCheck> ResetChecks;
+
+	static constexpr int32 NumberOfTickFrames = 60;
+
+	static constexpr int32 BurstSize = 256;
+
+	static constexpr int32 BurstsPerRound = 20;
+
+	// The lightweight instances are measured with this many times the number of actors
+	static constexpr int32 InstancesPerActor = 10;
+
+	// Without the template the actors are spawned like with SpawnActor, to compare the warm up times
+	void RunPooled(UClass* Class, int32 Size, int32 Rounds, bool bCloneFromTemplate = true);
+
+	void RunBaseline(UClass* Class, int32 Size, int32 Rounds);
+
+	// Update the given number of active actors with their own ticks or with the batched update of their pool
+	void RunTick(int32 Size, bool bBatchedUpdate);
+
+	// Spawn a burst of actors with a single batched call or with one call per actor, the latencies are measured per burst
+	void RunBurst(int32 Rounds, bool bBatched);
+
+	// Add and remove lightweight instances without any world or instanced mesh
+	void RunInstances(int32 Size, int32 Rounds);
+
+	void AddResetCheck(const TCHAR* Name, bool bPassed);
+
+	// Fill the latency and throughput values of the result, the latencies are in cycles
+	static void Evaluate(FResult& Result, TArray<uint64>& AcquireCycles, TArray<uint64>& ReleaseCycles);
+
+	static double GetPercentile(const TArray<uint64>& SortedCycles, float Percentile);
+
+	FString ToJson() const;
+};
@@ -0,0 +1,164 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "PoolClassDefaults.h"
+#include "GameFramework/Actor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/InheritableComponentHandler.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+#include "PoolableInterface.h"
+
+TMap<FObjectKey, TSharedPtr<const FPoolClassDefaults>> FPoolClassDefaultsRegistry::ClassesToDefaults;
+
+namespace PoolClassDefaults
+{
+	// Child blueprints can override the component templates of their parent blueprints
+	static UActorComponent* FindComponentTemplate(UClass* Class, USCS_Node* Node) {
+		for (UBlueprintGeneratedClass* BlueprintClass = Cast<UBlueprintGeneratedClass>(Class); BlueprintClass != nullptr; BlueprintClass = Cast<UBlueprintGeneratedClass>(BlueprintClass->GetSuperClass())) {
+			if (BlueprintClass->SimpleConstructionScript == Node->GetSCS()) break;
+
+			UInheritableComponentHandler* InheritableComponentHandler = BlueprintClass->GetInheritableComponentHandler();
+			UActorComponent* OverriddenTemplate = InheritableComponentHandler != nullptr ? InheritableComponentHandler->GetOverridenComponentTemplate(FComponentKey(Node)) : nullptr;
+			if (OverriddenTemplate != nullptr) return OverriddenTemplate;
+		}
+
+		return Node->ComponentTemplate;
+	}
+}
+
+void FPoolClassDefaults::AddReferencedObjects(FReferenceCollector& Collector) {
+	Properties.AddReferencedObjects(Collector);
+	for (auto& ComponentSettings : ComponentsSettings) {
+		ComponentSettings.Properties.AddReferencedObjects(Collector);
+	}
+}
+
+TSharedRef<const FPoolClassDefaults> FPoolClassDefaultsRegistry::Get(UClass* Class) {
+	check(IsInGameThread());
+	check(Class != nullptr);
+
+	const UObject* DefaultObject = Class->GetDefaultObject();
+	const TSharedPtr<const FPoolClassDefaults>* FoundDefaults = ClassesToDefaults.Find(FObjectKey(Class));
+	if (FoundDefaults != nullptr && (*FoundDefaults)->DefaultObject == FObjectKey(DefaultObject)) {
+		return FoundDefaults->ToSharedRef();
+	}
+
+	// New classes are rare, it is a good moment to forget the unloaded ones
+	if (FoundDefaults == nullptr) {
+		RemoveStaleClasses();
+	}
+
+	TSharedRef<FPoolClassDefaults> Defaults = MakeShared<FPoolClassDefaults>();
+	Defaults->DefaultObject = FObjectKey(DefaultObject);
+	Defaults->ObjectSettings.Class = Class;
+	Defaults->ObjectSettings.bImplementsPoolableInterface = Class->ImplementsInterface(UPoolableInterface::StaticClass());
+	Defaults->Properties.Capture(DefaultObject);
+
+	if (Class->IsChildOf(AActor::StaticClass())) {
+		AddActorDefaults(Class, *Defaults);
+	}
+
+	ClassesToDefaults.Add(FObjectKey(Class), Defaults);
+	return Defaults;
+}
+
+TSharedRef<const FPoolClassDefaults> FPoolClassDefaultsRegistry::CaptureConstructedActor(const AActor* Actor) {
+	check(IsInGameThread());
+	check(Actor != nullptr);
+
+	// The actor flags stay the ones of the class default object, the spawned actor might have changed them while it began play
+	UClass* Class = Actor->GetClass();
+	const TSharedRef<const FPoolClassDefaults> ClassDefaults = Get(Class);
+	if (ClassDefaults->bFromConstructedActor) return ClassDefaults;
+
+	TSharedRef<FPoolClassDefaults> Defaults = MakeShared<FPoolClassDefaults>();
+	Defaults->DefaultObject = ClassDefaults->DefaultObject;
+	Defaults->ObjectSettings = ClassDefaults->ObjectSettings;
+	Defaults->bFromConstructedActor = true;
+	Defaults->Properties.Capture(Actor);
+
+	// The spawned actor owns the components of the construction scripts, including the ones which are created by the blueprint graph
+	for (const UActorComponent* Component : Actor->GetComponents()) {
+		if (Component != nullptr) {
+			AddComponentSettings(Component, Component->GetFName(), *Defaults, Actor);
+		}
+	}
+
+	ClassesToDefaults.Add(FObjectKey(Class), Defaults);
+	return Defaults;
+}
+
+void FPoolClassDefaultsRegistry::Empty() {
+	check(IsInGameThread());
+	ClassesToDefaults.Empty();
+}
+
+void FPoolClassDefaultsRegistry::AddActorDefaults(UClass* Class, FPoolClassDefaults& Defaults) {
+	// A spawned actor enables its tick on BeginPlay if it can tick and starts with it
+	AActor* DefaultActor = CastChecked<AActor>(Class->GetDefaultObject());
+	FDefaultObjectSettings& ObjectSettings = Defaults.ObjectSettings;
+	ObjectSettings.bIsActor = true;
+	ObjectSettings.bStartWithTickEnabled = DefaultActor->PrimaryActorTick.bCanEverTick && DefaultActor->PrimaryActorTick.bStartWithTickEnabled;
+	ObjectSettings.TickInterval = DefaultActor->PrimaryActorTick.TickInterval;
+	ObjectSettings.bHiddenInGame = DefaultActor->bHidden;
+	ObjectSettings.LifeSpan = DefaultActor->InitialLifeSpan;
+	ObjectSettings.bCanBeDamaged = DefaultActor->bCanBeDamaged;
+
+	// The native components are default subobjects of the class default object, including the overrides of the blueprints
+	TArray<UObject*> DefaultSubobjects;
+	DefaultActor->GetDefaultSubobjects(DefaultSubobjects);
+	for (UObject* DefaultSubobject : DefaultSubobjects) {
+		const UActorComponent* Template = Cast<UActorComponent>(DefaultSubobject);
+		if (Template != nullptr) {
+			AddComponentSettings(Template, Template->GetFName(), Defaults);
+		}
+	}
+
+	// The blueprint components are created from the templates of the construction scripts of the class and its parent blueprints
+	for (UClass* CurrentClass = Class; CurrentClass != nullptr; CurrentClass = CurrentClass->GetSuperClass()) {
+		UBlueprintGeneratedClass* BlueprintClass = Cast<UBlueprintGeneratedClass>(CurrentClass);
+		if (BlueprintClass == nullptr || BlueprintClass->SimpleConstructionScript == nullptr) continue;
+
+		for (USCS_Node* Node : BlueprintClass->SimpleConstructionScript->GetAllNodes()) {
+			const UActorComponent* Template = Node != nullptr ? PoolClassDefaults::FindComponentTemplate(Class, Node) : nullptr;
+			if (Template != nullptr) {
+				// The created components are named like the variables, not like the templates
+				AddComponentSettings(Template, Node->GetVariableName(), Defaults);
+			}
+		}
+	}
+}
+
+void FPoolClassDefaultsRegistry::AddComponentSettings(const UActorComponent* Template, FName Name, FPoolClassDefaults& Defaults, const AActor* Owner) {
+	FDefaultComponentSettings& ComponentSettings = Defaults.ComponentsSettings.AddDefaulted_GetRef();
+	ComponentSettings.Name = Name;
+	ComponentSettings.Properties.Capture(Template, Owner);
+	ComponentSettings.bImplementsPoolableInterface = Template->GetClass()->ImplementsInterface(UPoolableInterface::StaticClass());
+	ComponentSettings.bStartWithTickEnabled = Template->PrimaryComponentTick.bCanEverTick && Template->PrimaryComponentTick.bStartWithTickEnabled;
+	ComponentSettings.TickInterval = Template->PrimaryComponentTick.TickInterval;
+	ComponentSettings.Tags = Template->ComponentTags;
+	ComponentSettings.bAutoActivate = Template->bAutoActivate;
+
+	const USceneComponent* SceneComponent = Cast<USceneComponent>(Template);
+	if (SceneComponent != nullptr) {
+		ComponentSettings.bIsSceneComponent = true;
+		ComponentSettings.RelativeTransform = SceneComponent->GetRelativeTransform();
+		ComponentSettings.bIsVisible = SceneComponent->bVisible;
+		ComponentSettings.bIsHidden = SceneComponent->bHiddenInGame;
+
+		const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Template);
+		if (StaticMeshComponent != nullptr) {
+			ComponentSettings.bIsStaticMeshComponent = true;
+			ComponentSettings.bIsSimulatingPhysics = StaticMeshComponent->BodyInstance.bSimulatePhysics;
+		}
+	}
+}
+
+void FPoolClassDefaultsRegistry::RemoveStaleClasses() {
+	for (auto It = ClassesToDefaults.CreateIterator(); It; ++It) {
+		if (It.Key().ResolveObjectPtr() == nullptr) {
+			It.RemoveCurrent();
+		}
+	}
+}
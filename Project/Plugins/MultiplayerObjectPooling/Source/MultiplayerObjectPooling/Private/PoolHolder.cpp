@@ -3,33 +3,59 @@
 #include "PoolHolder.h"
 #include "Engine.h"
 #include "PoolableInterface.h"
+#include "PoolStats.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Misc/ScopeExit.h"
 
 
 APoolHolder::APoolHolder() {
-	PrimaryActorTick.bCanEverTick = false;
+	// The pool only ticks if it updates its active objects in a batch
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	// Add a root component to stick the pool on the pool manager
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
 }
 
 void APoolHolder::Add(UObject* Object) {
-	FString Name = Object->GetName();
-	ObjectPool.Add(Name, Object);
-	AvailableObjects.Add(Name);
+	PushFreeSlot(RegisterObject(Object));
 
 	SetObjectActive(Object, false);
+}
 
-	// Add a timer and ignore the life span for actors with a life span
+int32 APoolHolder::RegisterObject(UObject* Object) {
+	int32 SlotIndex = FirstDeadSlot;
+	if (SlotIndex != INDEX_NONE) {
+		FirstDeadSlot = Slots[SlotIndex].Next;
+		Slots[SlotIndex].Next = INDEX_NONE;
+		NumberOfDeadSlots--;
+	}
+	else {
+		SlotIndex = Slots.AddDefaulted();
+		if (ContinuedSlotGenerations.IsValidIndex(SlotIndex)) {
+			Slots[SlotIndex].Generation = ContinuedSlotGenerations[SlotIndex] + 1;
+		}
+	}
+	Slots[SlotIndex].Object = Object;
+	Slots[SlotIndex].Key = Object;
+	Slots[SlotIndex].Name = Object->GetFName();
+	Slots[SlotIndex].bIsAvailable = false;
+	Slots[SlotIndex].AcquireTime = GetWorld()->GetTimeSeconds();
+	LinkSlot(SlotIndex, FirstUsedSlot, LastUsedSlot, false);
+	ObjectsToSlots.Add(Object, SlotIndex);
+	NamesToSlots.Add(Object->GetFName(), SlotIndex);
+
+	// The pool takes care of the life span, the actor would destroy itself otherwise
 	if (DefaultObjectSettings.LifeSpan > 0) {
 		Cast<AActor>(Object)->SetLifeSpan(0);
-		ObjectsToTimers.Add(Object, FTimerHandle());
 	}
+
+	return SlotIndex;
 }
 
 UObject* APoolHolder::GetUnused() {
-	if (AvailableObjects.Num() > 0) {
-		UObject* UnusedObject = GetSpecific(AvailableObjects.Pop(true));	
-
-		return UnusedObject;
+	const int32 SlotIndex = GetFirstValidFreeSlot();
+	if (SlotIndex != INDEX_NONE) {
+		return AcquireSlot(SlotIndex);
 	}
 	else {
 		return nullptr;
@@ -37,123 +63,852 @@ UObject* APoolHolder::GetUnused() {
 }
 
 UObject* APoolHolder::GetNew() {
+	if (!CanGrow()) return nullptr;
+
+	Add(CreateObject());
+
+	UObject* Object = TakeSlot(FirstFreeSlot);
+	UpdatePeakInUse();
+	return Object;
+}
+
+UObject* APoolHolder::RecycleOldest() {
+	// The used slots are linked in acquire order, the oldest one is the head. Objects which have been destroyed by the gameplay are skipped
+	for (int32 SlotIndex = FirstUsedSlot; SlotIndex != INDEX_NONE; SlotIndex = Slots[SlotIndex].Next) {
+		if (IsValid(Slots[SlotIndex].Object)) {
+			return RecycleSlot(SlotIndex);
+		}
+	}
+
+	return nullptr;
+}
+
+int32 APoolHolder::RecycleOldest(int32 Quantity, TArray<UObject*>& OutObjects) {
+	// Pick the slots first, every recycled slot moves to the end of the used list and mustn't be picked again
+	TArray<int32, TInlineAllocator<16>> SlotIndices;
+	for (int32 SlotIndex = FirstUsedSlot; SlotIndex != INDEX_NONE && SlotIndices.Num() < Quantity; SlotIndex = Slots[SlotIndex].Next) {
+		if (IsValid(Slots[SlotIndex].Object)) {
+			SlotIndices.Add(SlotIndex);
+		}
+	}
+
+	for (const int32 SlotIndex : SlotIndices) {
+		OutObjects.Add(RecycleSlot(SlotIndex));
+	}
+
+	return SlotIndices.Num();
+}
+
+UObject* APoolHolder::RecycleSlot(int32 SlotIndex) {
+	UObject* Object = Slots[SlotIndex].Object;
+
+	// Unbind a promoted actor first, otherwise returning it would free its instance
+	if (PromotedActorsToInstances.Num() > 0 && DefaultObjectSettings.bIsActor) {
+		AActor* Actor = Cast<AActor>(Object);
+		const FPoolInstanceHandle Handle = UnbindPromotedActor(Actor);
+		if (Handle.IsValid()) {
+			Instances.Demote(Handle, Actor->GetActorTransform());
+		}
+	}
+
+	// Returning the object calls PoolableEndPlay
+	ReturnObject(Object);
+	return TakeSlot(SlotIndex);
+}
+
+UObject* APoolHolder::CreateObject() {
+	UObject* Object;
 	if (DefaultObjectSettings.bIsActor) {
-		AActor* NewActor = GetWorld()->SpawnActor(DefaultObjectSettings.Class);
-		Add(NewActor);
+		if (TemplateActor != nullptr) {
+			// The actor is born deactivated, so its components don't create any scene proxies or physics bodies
+			FActorSpawnParameters SpawnParameters;
+			SpawnParameters.Template = TemplateActor;
+			Object = GetWorld()->SpawnActor(DefaultObjectSettings.Class, nullptr, nullptr, SpawnParameters);
+		}
+		else {
+			Object = GetWorld()->SpawnActor(DefaultObjectSettings.Class);
+		}
 	}
 	else {
-		Add(NewObject<UObject>((UObject*)GetTransientPackage(), DefaultObjectSettings.Class));
+		// The pool holder is the outer to find the world of the object
+		Object = NewObject<UObject>(this, DefaultObjectSettings.Class);
 	}
 
-	return GetUnused();
+	if (BytesPerObject == 0) {
+		MeasureFirstObject(Object);
+	}
+
+	// The class default object doesn't know the values of the construction scripts, they are taken from the first spawned actor
+	if (DefaultObjectSettings.bIsActor && IsValid(Object) && !ClassDefaults->bFromConstructedActor) {
+		ClassDefaults = FPoolClassDefaultsRegistry::CaptureConstructedActor(CastChecked<AActor>(Object));
+	}
+	return Object;
 }
 
 TArray<UObject*> APoolHolder::GetAllUnused() {
 	TArray<UObject*> Objects;
-	for (int i = 0; i < AvailableObjects.Num(); i++) {
-		Objects.Add(GetSpecific(AvailableObjects[i]));
+	Objects.Reserve(NumberOfAvailableObjects);
+	while (GetFirstValidFreeSlot() != INDEX_NONE) {
+		Objects.Add(AcquireSlot(FirstFreeSlot));
 	}
-	AvailableObjects.Empty();
 
 	return Objects;
 }
 
+int32 APoolHolder::GetUnused(int32 Quantity, TArray<UObject*>& OutObjects, bool bGrow) {
+	const int32 NumberOfObjects = OutObjects.Num();
+	OutObjects.Reserve(NumberOfObjects + Quantity);
+
+	while (OutObjects.Num() - NumberOfObjects < Quantity && GetFirstValidFreeSlot() != INDEX_NONE) {
+		OutObjects.Add(AcquireSlot(FirstFreeSlot));
+	}
+
+	const int32 NumberOfMissingObjects = Quantity - (OutObjects.Num() - NumberOfObjects);
+	if (bGrow && NumberOfMissingObjects > 0 && DefaultObjectSettings.Class) {
+		// The new objects are deactivated like the warmed up ones, so they are handed out in the same state as the available ones
+		Slots.Reserve(Slots.Num() + NumberOfMissingObjects);
+		ObjectsToSlots.Reserve(Slots.Num() + NumberOfMissingObjects);
+		NamesToSlots.Reserve(Slots.Num() + NumberOfMissingObjects);
+		bIsPoolHolderInitialized = false;
+		for (int i = 0; i < NumberOfMissingObjects && CanGrow(); i++) {
+			Add(CreateObject());
+		}
+		bIsPoolHolderInitialized = true;
+
+		while (FirstFreeSlot != INDEX_NONE && OutObjects.Num() - NumberOfObjects < Quantity) {
+			OutObjects.Add(TakeSlot(FirstFreeSlot));
+		}
+		UpdatePeakInUse();
+	}
+
+	return OutObjects.Num() - NumberOfObjects;
+}
+
 UObject* APoolHolder::GetSpecific(FString ObjectName) {
-	// TODO: Bad performance, find a better way
-	AvailableObjects.Remove(ObjectName);
+	// Only look up existing names, an unknown name can't be a part of the pool
+	return GetSpecific(FName(*ObjectName, FNAME_Find));
+}
+
+UObject* APoolHolder::GetSpecific(FPoolObjectId ObjectId) {
+	if (ObjectId.GetPoolIndex() != PoolIndex) return nullptr;
 
-	UObject** ObjectFromPool = ObjectPool.Find(ObjectName);
+	const int32 SlotIndex = ObjectId.GetSlotIndex();
+	if (!Slots.IsValidIndex(SlotIndex)) return nullptr;
+	const FPoolSlot& Slot = Slots[SlotIndex];
+	if (!Slot.bIsAvailable || Slot.Generation != ObjectId.GetGeneration()) return nullptr;
+	if (!IsValid(Slot.Object)) {
+		RetireSlot(SlotIndex);
+		return nullptr;
+	}
 
-	if (ObjectFromPool == nullptr) return nullptr;
+	return AcquireSlot(SlotIndex);
+}
 
-	UObject* UnusedObject = *ObjectFromPool;
+FPoolObjectId APoolHolder::GetObjectId(UObject* Object) const {
+	const int32 SlotIndex = FindSlot(Object);
+	if (SlotIndex == INDEX_NONE) return FPoolObjectId();
 
-	return UnusedObject;
+	if (PoolIndex >= FPoolObjectId::MaxPools || SlotIndex >= FPoolObjectId::MaxSlots) {
+		if (!bHasReportedIdOverflow) {
+			bHasReportedIdOverflow = true;
+			UE_LOG(LogTemp, Error, TEXT("The objects of the pool %s don't get an id, the pool index %d or the slot index %d exceeds the limit of %d pools with %d slots each!"), *GetNameSafe(GetPoolClass()), PoolIndex, SlotIndex, FPoolObjectId::MaxPools, FPoolObjectId::MaxSlots);
+		}
+		return FPoolObjectId();
+	}
+
+	return FPoolObjectId(PoolIndex, SlotIndex, Slots[SlotIndex].Generation);
+}
+
+void APoolHolder::CheckStableIds(bool bIsTrimmedByGlobalBudget) const {
+	if (bHasReportedUnstableIds) return;
+
+	if (bIsTrimmedByGlobalBudget || SizingPolicy.bEnabled || MemoryBudgetBytes > 0 || Stats.MissesCreatedAndAdded > 0) {
+		bHasReportedUnstableIds = true;
+		UE_LOG(LogTemp, Warning, TEXT("The ids of the pool %s can differ between the peers, its slots are created or destroyed depending on the timing (adaptive size, memory budget or growth on demand)!"), *GetNameSafe(GetPoolClass()));
+	}
+}
+
+UObject* APoolHolder::GetObjectById(FPoolObjectId ObjectId) const {
+	if (!ObjectId.IsValid() || ObjectId.GetPoolIndex() != PoolIndex) return nullptr;
+
+	const int32 SlotIndex = ObjectId.GetSlotIndex();
+	if (!Slots.IsValidIndex(SlotIndex) || Slots[SlotIndex].Generation != ObjectId.GetGeneration()) return nullptr;
+
+	return Slots[SlotIndex].Object;
+}
+
+UObject* APoolHolder::GetSpecific(FName ObjectName) {
+	const int32* SlotIndex = NamesToSlots.Find(ObjectName);
+	if (SlotIndex == nullptr) return nullptr;
+	if (!Slots[*SlotIndex].bIsAvailable) return nullptr;
+	if (!IsValid(Slots[*SlotIndex].Object)) {
+		RetireSlot(*SlotIndex);
+		return nullptr;
+	}
+
+	return AcquireSlot(*SlotIndex);
 }
 
 void APoolHolder::ReturnObject(UObject* Object) {
-	FString ObjectName = Object->GetName();
-	AvailableObjects.Add(ObjectName);
+	SCOPE_CYCLE_COUNTER(STAT_PoolRelease);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	const int32 SlotIndex = FindSlot(Object);
+	if (SlotIndex == INDEX_NONE) {
+		// The object was created outside of the pool, adopt it if the pool can still grow
+		if (IsValid(Object) && Object->IsA(DefaultObjectSettings.Class)) {
+			if (CanGrow()) {
+				Add(Object);
+			}
+			else if (AActor* Actor = Cast<AActor>(Object)) {
+				Actor->Destroy();
+			}
+			else {
+				Object->MarkPendingKill();
+			}
+		}
+		return;
+	}
+	if (Slots[SlotIndex].bIsAvailable) return;
+
+	// The gameplay has destroyed the object while it was used
+	if (!IsValid(Object)) {
+		RetireSlot(SlotIndex);
+		return;
+	}
+
+	PushFreeSlot(SlotIndex);
 
 	SetObjectActive(Object, false);
+
+	Stats.Releases++;
+	Stats.ReleaseCycles += FPlatformTime::Cycles64() - StartCycles;
+	INC_DWORD_STAT(STAT_PoolReleases);
+}
+
+void APoolHolder::ReturnObjects(TArrayView<UObject*> Objects) {
+	SCOPE_CYCLE_COUNTER(STAT_PoolRelease);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// Make all the objects available first, duplicates are skipped because their slot is already free
+	int32 NumberOfReturnedObjects = 0;
+	for (auto& Object : Objects) {
+		const int32 SlotIndex = FindSlot(Object);
+		if (SlotIndex == INDEX_NONE) {
+			ReturnObject(Object);
+		}
+		else if (!IsValid(Object)) {
+			if (!Slots[SlotIndex].bIsAvailable) {
+				RetireSlot(SlotIndex);
+			}
+		}
+		else if (!Slots[SlotIndex].bIsAvailable) {
+			PushFreeSlot(SlotIndex);
+			Objects[NumberOfReturnedObjects++] = Object;
+		}
+	}
+
+	DeactivateObjects(MakeArrayView(Objects.GetData(), NumberOfReturnedObjects));
+
+	Stats.Releases += NumberOfReturnedObjects;
+	Stats.ReleaseCycles += FPlatformTime::Cycles64() - StartCycles;
+	INC_DWORD_STAT_BY(STAT_PoolReleases, NumberOfReturnedObjects);
+}
+
+UObject* APoolHolder::AcquireSlot(int32 SlotIndex) {
+	UObject* Object = TakeSlot(SlotIndex);
+	Stats.Hits++;
+	UpdatePeakInUse();
+	return Object;
+}
+
+void APoolHolder::UpdatePeakInUse() {
+	Stats.PeakInUse = FMath::Max(Stats.PeakInUse, GetNumberOfUsedObjects());
+}
+
+void APoolHolder::PublishStats() {
+#if CSV_PROFILER
+	const int32 NumberOfUsedObjects = GetNumberOfUsedObjects();
+	FCsvProfiler::RecordCustomStat(CsvStatNameInUse, CSV_CATEGORY_INDEX(ObjectPool), NumberOfUsedObjects, ECsvCustomStatOp::Set);
+	FCsvProfiler::RecordCustomStat(CsvStatNameAvailable, CSV_CATEGORY_INDEX(ObjectPool), NumberOfAvailableObjects, ECsvCustomStatOp::Set);
+	FCsvProfiler::RecordCustomStat(CsvStatNameMisses, CSV_CATEGORY_INDEX(ObjectPool), Stats.GetMisses(), ECsvCustomStatOp::Set);
+#endif
 }
 
-void APoolHolder::SetObjectActive(UObject* Object, bool bIsActive) {
+int32 APoolHolder::FindSlot(UObject* Object) const {
+	// A new object might have been allocated at the address of a collected one whose slot hasn't been retired yet
+	const int32* SlotIndex = ObjectsToSlots.Find(Object);
+	return SlotIndex != nullptr && Slots[*SlotIndex].Object == Object ? *SlotIndex : INDEX_NONE;
+}
+
+void APoolHolder::PushFreeSlot(int32 SlotIndex) {
+	UnlinkSlot(SlotIndex, FirstUsedSlot, LastUsedSlot);
+	LinkSlot(SlotIndex, FirstFreeSlot, LastFreeSlot, true);
+	Slots[SlotIndex].bIsAvailable = true;
+	Slots[SlotIndex].Generation++;
+	NumberOfAvailableObjects++;
+	ClearDeferredActivation(SlotIndex);
+}
+
+void APoolHolder::ClearDeferredActivation(int32 SlotIndex) {
+	if (Slots[SlotIndex].bIsActivationDeferred) {
+		Slots[SlotIndex].bIsActivationDeferred = false;
+		NumberOfDeferredActivations--;
+	}
+}
+
+void APoolHolder::BeginDeferredActivation(UObject* Object) {
+	const int32 SlotIndex = FindSlot(Object);
+	if (SlotIndex == INDEX_NONE || Slots[SlotIndex].bIsAvailable || Slots[SlotIndex].bIsActivationDeferred) return;
+
+	Slots[SlotIndex].bIsActivationDeferred = true;
+	NumberOfDeferredActivations++;
+}
+
+bool APoolHolder::FinishDeferredActivation(UObject* Object) {
+	const int32 SlotIndex = FindSlot(Object);
+	if (SlotIndex == INDEX_NONE || !Slots[SlotIndex].bIsActivationDeferred) return false;
+
+	ClearDeferredActivation(SlotIndex);
+	return true;
+}
+
+bool APoolHolder::IsActivationDeferred(UObject* Object) const {
+	const int32 SlotIndex = FindSlot(Object);
+	return SlotIndex != INDEX_NONE && Slots[SlotIndex].bIsActivationDeferred;
+}
+
+UObject* APoolHolder::TakeSlot(int32 SlotIndex) {
+	UnlinkSlot(SlotIndex, FirstFreeSlot, LastFreeSlot);
+	LinkSlot(SlotIndex, FirstUsedSlot, LastUsedSlot, false);
+
+	FPoolSlot& Slot = Slots[SlotIndex];
+	Slot.bIsAvailable = false;
+	Slot.AcquireTime = GetWorld()->GetTimeSeconds();
+	NumberOfAvailableObjects--;
+
+	return Slot.Object;
+}
+
+void APoolHolder::LinkSlot(int32 SlotIndex, int32& FirstSlot, int32& LastSlot, bool bAddToFront) {
+	FPoolSlot& Slot = Slots[SlotIndex];
+	if (bAddToFront) {
+		Slot.Prev = INDEX_NONE;
+		Slot.Next = FirstSlot;
+		if (FirstSlot != INDEX_NONE) {
+			Slots[FirstSlot].Prev = SlotIndex;
+		}
+		else {
+			LastSlot = SlotIndex;
+		}
+		FirstSlot = SlotIndex;
+	}
+	else {
+		Slot.Prev = LastSlot;
+		Slot.Next = INDEX_NONE;
+		if (LastSlot != INDEX_NONE) {
+			Slots[LastSlot].Next = SlotIndex;
+		}
+		else {
+			FirstSlot = SlotIndex;
+		}
+		LastSlot = SlotIndex;
+	}
+}
+
+void APoolHolder::UnlinkSlot(int32 SlotIndex, int32& FirstSlot, int32& LastSlot) {
+	FPoolSlot& Slot = Slots[SlotIndex];
+	if (Slot.Prev != INDEX_NONE) {
+		Slots[Slot.Prev].Next = Slot.Next;
+	}
+	else {
+		FirstSlot = Slot.Next;
+	}
+	if (Slot.Next != INDEX_NONE) {
+		Slots[Slot.Next].Prev = Slot.Prev;
+	}
+	else {
+		LastSlot = Slot.Prev;
+	}
+	Slot.Prev = INDEX_NONE;
+	Slot.Next = INDEX_NONE;
+}
+
+int32 APoolHolder::ReturnExpiredObjects(float WorldTime) {
+	// The life span of the objects of a pool with a batched update runs out inside the update
+	if (DefaultObjectSettings.LifeSpan <= 0 || bBatchedUpdate) return 0;
+
+	// All objects share the same life span, so the used list is sorted by the expiry time as well
+	const float ExpiredAcquireTime = WorldTime - DefaultObjectSettings.LifeSpan;
+	TArray<UObject*, TInlineAllocator<32>> ExpiredObjects;
+	int32 SlotIndex = FirstUsedSlot;
+	while (SlotIndex != INDEX_NONE && Slots[SlotIndex].AcquireTime <= ExpiredAcquireTime) {
+		const int32 NextSlotIndex = Slots[SlotIndex].Next;
+
+		// The objects which have been destroyed by the gameplay don't go back to the pool
+		if (IsValid(Slots[SlotIndex].Object)) {
+			ExpiredObjects.Add(Slots[SlotIndex].Object);
+		}
+		else {
+			RetireSlot(SlotIndex);
+		}
+		SlotIndex = NextSlotIndex;
+	}
+
+	if (ExpiredObjects.Num() > 0) {
+		ReturnObjects(ExpiredObjects);
+	}
+
+	return ExpiredObjects.Num();
+}
+
+void APoolHolder::SetObjectActive(UObject* Object, bool bIsActive, bool bRestoreDefaults) {
 	if (!IsValid(Object)) return;
 
+	if (!bIsActive) {
+		DeactivateObjects(MakeArrayView(&Object, 1));
+		return;
+	}
+
+	// An object which is activated without finishing its deferred spawn mustn't be activated a second time by the finish
+	if (NumberOfDeferredActivations > 0) {
+		const int32 SlotIndex = FindSlot(Object);
+		if (SlotIndex != INDEX_NONE) {
+			ClearDeferredActivation(SlotIndex);
+		}
+	}
+
 	if (DefaultObjectSettings.bIsActor) {
 		AActor* Actor = Cast<AActor>(Object);
 
-		// Attach and detach the actor on the pool for better readability inside the editor
-		if (bIsActive) {
+		if (bRestoreDefaults) {
 			RestoreActorSettings(Actor);
+		}
+
+		switch (DeactivationStrategy) {
+		case EPoolDeactivationStrategy::FULL_DISABLE:
+			// Attach and detach the actor on the pool for better readability inside the editor
 			if (Actor->GetAttachParentActor() == this) {
 				Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
 			}
+			Actor->SetActorEnableCollision(true);
+			break;
+
+		case EPoolDeactivationStrategy::PARK_OFF_WORLD: {
+			UPrimitiveComponent* RootPrimitive = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+			if (RootPrimitive != nullptr && RootPrimitive->IsSimulatingPhysics()) {
+				RootPrimitive->WakeAllRigidBodies();
+			}
+			break;
 		}
-		else {
-			Actor->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
+
+		case EPoolDeactivationStrategy::HIDE_ONLY:
+			break;
 		}
 
-		Actor->SetActorHiddenInGame(!bIsActive || DefaultObjectSettings.bHiddenInGame);
-		Actor->SetActorEnableCollision(bIsActive);
-		Actor->SetActorTickEnabled(bIsActive && DefaultObjectSettings.bStartWithTickEnabled);
+		Actor->SetActorHiddenInGame(DefaultObjectSettings.bHiddenInGame);
+		// The objects of a pool with a batched update are updated by the tick of the pool
+		Actor->SetActorTickEnabled(DefaultObjectSettings.bStartWithTickEnabled && !bBatchedUpdate);
+	}
+	else if (bRestoreDefaults) {
+		ClassDefaults->Properties.RestoreDirty(Object);
 	}
 
 	if (DefaultObjectSettings.bImplementsPoolableInterface && bIsPoolHolderInitialized) {
-		if (bIsActive) {
-			IPoolableInterface::Execute_PoolableBeginPlay(Object);
-		}
-		else {
+		IPoolableInterface::Execute_PoolableBeginPlay(Object);
+	}
+
+	if (bBatchedUpdate && bIsPoolHolderInitialized) {
+		AddToBatchedUpdate(Object);
+	}
+}
+
+void APoolHolder::DeactivateObjects(TArrayView<UObject*> Objects) {
+	// Every step runs over the whole batch before the next one starts, so the gameplay of all objects has ended before their state changes
+	for (UObject* Object : Objects) {
+		if (!IsValid(Object)) continue;
+
+		if (DefaultObjectSettings.bImplementsPoolableInterface && bIsPoolHolderInitialized) {
 			IPoolableInterface::Execute_PoolableEndPlay(Object);
 		}
+
+		if (bBatchedUpdate && bIsPoolHolderInitialized) {
+			RemoveFromBatchedUpdate(Object);
+		}
+	}
+
+	if (!DefaultObjectSettings.bIsActor) return;
+
+	// An actor which is returned while it represents an instance ends the lifetime of the instance
+	if (PromotedActorsToInstances.Num() > 0) {
+		for (UObject* Object : Objects) {
+			if (IsValid(Object)) {
+				Instances.Remove(UnbindPromotedActor(Cast<AActor>(Object)));
+			}
+		}
+	}
+
+	for (UObject* Object : Objects) {
+		if (IsValid(Object)) {
+			Cast<AActor>(Object)->SetActorTickEnabled(false);
+		}
+	}
+
+	// The collision and physics state of the whole pool changes in one pass
+	switch (DeactivationStrategy) {
+	case EPoolDeactivationStrategy::FULL_DISABLE:
+		for (UObject* Object : Objects) {
+			if (IsValid(Object)) {
+				// Attach the actor on the pool for better readability inside the editor
+				AActor* Actor = Cast<AActor>(Object);
+				Actor->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
+				Actor->SetActorEnableCollision(false);
+			}
+		}
+		break;
+
+	case EPoolDeactivationStrategy::PARK_OFF_WORLD:
+		for (UObject* Object : Objects) {
+			if (IsValid(Object)) {
+				ParkActor(Cast<AActor>(Object));
+			}
+		}
+		break;
+
+	case EPoolDeactivationStrategy::HIDE_ONLY:
+		break;
+	}
+
+	// Hiding only marks the render state dirty, the render state of the whole batch is sent to the render thread once at the end of the frame
+	for (UObject* Object : Objects) {
+		if (IsValid(Object)) {
+			Cast<AActor>(Object)->SetActorHiddenInGame(true);
+		}
+	}
+}
+
+void APoolHolder::AddToBatchedUpdate(UObject* Object) {
+	const int32 SlotIndex = FindSlot(Object);
+	if (SlotIndex == INDEX_NONE || Slots[SlotIndex].BatchIndex != INDEX_NONE) return;
+
+	// Only native classes can implement the update, the interface pointer is null for blueprints
+	IPoolableInterface* PoolableInterface = Cast<IPoolableInterface>(Object);
+	FVector Velocity = FVector::ZeroVector;
+	float LifeSpan = DefaultObjectSettings.LifeSpan > 0 ? DefaultObjectSettings.LifeSpan : TNumericLimits<float>::Max();
+	if (PoolableInterface != nullptr) {
+		PoolableInterface->PoolableBeginUpdate(Velocity, LifeSpan);
+	}
+
+	Slots[SlotIndex].BatchIndex = BatchedSlots.Add(SlotIndex);
+	BatchedObjects.Add(Object);
+	BatchedInterfaces.Add(PoolableInterface);
+	BatchedLocations.AddZeroed();
+	BatchedVelocities.Add(Velocity);
+	BatchedLifeSpans.Add(LifeSpan);
+}
+
+void APoolHolder::RemoveFromBatchedUpdate(UObject* Object) {
+	const int32 SlotIndex = FindSlot(Object);
+	if (SlotIndex == INDEX_NONE || Slots[SlotIndex].BatchIndex == INDEX_NONE) return;
+
+	RemoveBatchedIndex(Slots[SlotIndex].BatchIndex);
+}
+
+void APoolHolder::RemoveBatchedIndex(int32 BatchIndex) {
+	// Keep the arrays dense, the last object takes the place of the removed one
+	const int32 LastBatchIndex = BatchedSlots.Num() - 1;
+	if (BatchIndex != LastBatchIndex) {
+		Slots[BatchedSlots[LastBatchIndex]].BatchIndex = BatchIndex;
+	}
+	Slots[BatchedSlots[BatchIndex]].BatchIndex = INDEX_NONE;
+
+	BatchedSlots.RemoveAtSwap(BatchIndex, 1, false);
+	BatchedObjects.RemoveAtSwap(BatchIndex, 1, false);
+	BatchedInterfaces.RemoveAtSwap(BatchIndex, 1, false);
+	BatchedLocations.RemoveAtSwap(BatchIndex, 1, false);
+	BatchedVelocities.RemoveAtSwap(BatchIndex, 1, false);
+	BatchedLifeSpans.RemoveAtSwap(BatchIndex, 1, false);
+}
+
+void APoolHolder::Tick(float DeltaSeconds) {
+	Super::Tick(DeltaSeconds);
+
+	if (BatchedObjects.Num() > 0) {
+		UpdateBatchedObjects(DeltaSeconds);
+	}
+}
+
+void APoolHolder::UpdateBatchedObjects(float DeltaSeconds) {
+	SCOPE_CYCLE_COUNTER(STAT_PoolBatchedUpdate);
+
+	// Drop the objects which have been destroyed by the gameplay while they were active
+	for (int32 i = BatchedObjects.Num() - 1; i >= 0; i--) {
+		if (!IsValid(BatchedObjects[i])) {
+			RemoveBatchedIndex(i);
+		}
+	}
+
+	// Gather the locations first, the actors might have been moved since the last update
+	const bool bIsActor = DefaultObjectSettings.bIsActor;
+	if (bIsActor) {
+		for (int32 i = 0; i < BatchedObjects.Num(); i++) {
+			BatchedLocations[i] = static_cast<AActor*>(BatchedObjects[i])->GetActorLocation();
+		}
+	}
+
+	// The update callbacks may acquire or return objects, which swaps and reallocates the batched arrays.
+	// Walk a copy of the batch and look up the current index of every object, so each one is updated at most once.
+	const TArray<int32, TInlineAllocator<32>> PendingSlots(BatchedSlots);
+	const TArray<UObject*, TInlineAllocator<32>> PendingObjects(BatchedObjects);
+
+	TArray<UObject*, TInlineAllocator<32>> ExpiredObjects;
+	for (int32 i = 0; i < PendingSlots.Num(); i++) {
+		const int32 SlotIndex = PendingSlots[i];
+		UObject* Object = PendingObjects[i];
+
+		// Returned or retired by the update of another object
+		int32 BatchIndex = Slots[SlotIndex].BatchIndex;
+		if (BatchIndex == INDEX_NONE || BatchedObjects[BatchIndex] != Object) continue;
+
+		// Destroyed by the update of another object
+		if (!IsValid(Object)) {
+			RemoveBatchedIndex(BatchIndex);
+			continue;
+		}
+
+		FVector Location = BatchedLocations[BatchIndex];
+		FVector Velocity = BatchedVelocities[BatchIndex];
+		float LifeSpan = BatchedLifeSpans[BatchIndex];
+		const FVector PreviousLocation = Location;
+
+		if (BatchedInterfaces[BatchIndex] != nullptr) {
+			BatchedInterfaces[BatchIndex]->PoolableUpdate(DeltaSeconds, Location, Velocity, LifeSpan);
+
+			// The update returned the object to the pool anyway, or moved it to another index
+			BatchIndex = Slots[SlotIndex].BatchIndex;
+			if (BatchIndex == INDEX_NONE || BatchedObjects[BatchIndex] != Object || !IsValid(Object)) continue;
+		}
+
+		Location += Velocity * DeltaSeconds;
+		LifeSpan -= DeltaSeconds;
+
+		BatchedLocations[BatchIndex] = Location;
+		BatchedVelocities[BatchIndex] = Velocity;
+		BatchedLifeSpans[BatchIndex] = LifeSpan;
+
+		if (LifeSpan <= 0.f) {
+			ExpiredObjects.Add(Object);
+		}
+		else if (bIsActor && Location != PreviousLocation) {
+			static_cast<AActor*>(Object)->SetActorLocation(Location, false, nullptr, ETeleportType::None);
+		}
+	}
+
+	if (ExpiredObjects.Num() > 0) {
+		ReturnObjects(ExpiredObjects);
+	}
+}
+
+FPoolInstanceHandle APoolHolder::AddInstance(const FTransform& Transform, const FVector4& Payload) {
+	if (InstancedMeshComponent == nullptr) return FPoolInstanceHandle();
+
+	return Instances.Add(Transform, Payload);
+}
+
+bool APoolHolder::RemoveInstance(FPoolInstanceHandle Handle) {
+	AActor* Actor = GetPromotedActor(Handle);
+	if (Actor != nullptr) {
+		// Returning the actor frees its instance as well
+		ReturnObject(Actor);
+		return true;
+	}
+
+	return Instances.Remove(Handle);
+}
+
+bool APoolHolder::PromoteInstance(FPoolInstanceHandle Handle, AActor* Actor) {
+	if (!IsValid(Actor) || FindSlot(Actor) == INDEX_NONE || PromotedActorsToInstances.Contains(Actor)) return false;
+
+	FTransform Transform;
+	if (!Instances.GetTransform(Handle, Transform) || !Instances.Promote(Handle)) return false;
+
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	PromotedActorsToInstances.Add(Actor, Handle);
+	InstancesToPromotedActors.Add(Handle.InstanceIndex, Actor);
+	return true;
+}
+
+FPoolInstanceHandle APoolHolder::DemoteActor(AActor* Actor) {
+	if (InstancedMeshComponent == nullptr || !IsValid(Actor) || IsObjectAvailable(Actor)) return FPoolInstanceHandle();
+
+	// Unbind the actor first, otherwise returning it would free its instance
+	FPoolInstanceHandle Handle = UnbindPromotedActor(Actor);
+	if (Handle.IsValid()) {
+		Instances.Demote(Handle, Actor->GetActorTransform());
+	}
+	else {
+		Handle = Instances.Add(Actor->GetActorTransform());
+	}
+
+	ReturnObject(Actor);
+	return Handle;
+}
+
+AActor* APoolHolder::GetPromotedActor(FPoolInstanceHandle Handle) const {
+	if (Instances.GetState(Handle) != FPoolInstanceSet::EState::Promoted) return nullptr;
+
+	AActor* const* Actor = InstancesToPromotedActors.Find(Handle.InstanceIndex);
+	return Actor != nullptr ? *Actor : nullptr;
+}
+
+FPoolInstanceHandle APoolHolder::UnbindPromotedActor(AActor* Actor) {
+	FPoolInstanceHandle Handle;
+	if (PromotedActorsToInstances.RemoveAndCopyValue(Actor, Handle)) {
+		InstancesToPromotedActors.Remove(Handle.InstanceIndex);
+	}
+	return Handle;
+}
+
+void APoolHolder::FlushInstances() {
+	if (InstancedMeshComponent == nullptr) return;
+
+	Instances.ConsumeDirtyInstances(DirtyInstances);
+	if (DirtyInstances.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_PoolInstanceFlush);
+
+	// The render instances are only appended and never removed, so their indices match the instances of the pool
+	const int32 NumberOfRenderInstances = InstancedMeshComponent->GetInstanceCount();
+	for (int32 InstanceIndex : DirtyInstances) {
+		if (InstanceIndex < NumberOfRenderInstances) {
+			InstancedMeshComponent->UpdateInstanceTransform(InstanceIndex, Instances.GetRenderTransform(InstanceIndex), true, false, true);
+		}
+	}
+	for (int32 InstanceIndex = NumberOfRenderInstances; InstanceIndex < Instances.Num(); InstanceIndex++) {
+		InstancedMeshComponent->AddInstanceWorldSpace(Instances.GetRenderTransform(InstanceIndex));
+	}
+
+	// Rebuild the render data once for all changed instances
+	InstancedMeshComponent->MarkRenderStateDirty();
+}
+
+void APoolHolder::CreateInstancedMesh(const FPoolEntry& PoolEntry) {
+	if (!DefaultObjectSettings.bIsActor) {
+		UE_LOG(LogTemp, Warning, TEXT("The pool of %s can't use an instanced mesh, only actors can be promoted!"), *GetNameSafe(DefaultObjectSettings.Class));
+		return;
+	}
+
+	// The instances are placed in world space, the component stays at the origin while the pool is attached to the pool manager
+	InstancedMeshComponent = NewObject<UInstancedStaticMeshComponent>(this, TEXT("InstancedMesh"));
+	InstancedMeshComponent->SetupAttachment(RootComponent);
+	InstancedMeshComponent->SetAbsolute(true, true, true);
+	InstancedMeshComponent->SetMobility(EComponentMobility::Movable);
+	// The instances are visual only, the promoted actors provide the collision
+	InstancedMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InstancedMeshComponent->SetCanEverAffectNavigation(false);
+	InstancedMeshComponent->SetStaticMesh(PoolEntry.InstancedMesh);
+	InstancedMeshComponent->RegisterComponent();
+
+	Instances.Initialize(PoolIndex);
+	Instances.Reserve(PoolEntry.AmountOfInstances);
+	FlushInstances();
+}
+
+void APoolHolder::CreateTemplateActor(UClass* Class) {
+	// The template is only constructed, like the template of a child actor component. The construction scripts run for every spawned actor
+	TemplateActor = NewObject<AActor>(this, Class, NAME_None, RF_ArchetypeObject | RF_Transient);
+	TemplateActor->bHidden = true;
+	TemplateActor->PrimaryActorTick.bStartWithTickEnabled = false;
+	if (DeactivationStrategy == EPoolDeactivationStrategy::FULL_DISABLE) {
+		TemplateActor->SetActorEnableCollision(false);
+	}
+}
+
+void APoolHolder::ParkActor(AActor* Actor) {
+	// Every slot gets its own parking spot as long as the grid has enough spots
+	const int32 SlotIndex = FMath::Max(FindSlot(Actor), 0);
+	const int32 SpotIndex = SlotIndex % (ParkingGridSize.X * ParkingGridSize.Y * ParkingGridSize.Z);
+	const FVector Spot(SpotIndex % ParkingGridSize.X, (SpotIndex / ParkingGridSize.X) % ParkingGridSize.Y, SpotIndex / (ParkingGridSize.X * ParkingGridSize.Y));
+	const FVector Location = ParkingLocation + Spot * ParkingGridStep;
+	Actor->SetActorLocation(Location, false, nullptr, ETeleportType::ResetPhysics);
+
+	UPrimitiveComponent* RootPrimitive = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+	if (RootPrimitive != nullptr) {
+		RootPrimitive->PutAllRigidBodiesToSleep();
+	}
+}
+
+void APoolHolder::InitializeParkingGrid() {
+	const float Spacing = FMath::Max(ParkingSpacing, 1.f);
+	auto GetNumberOfSpots = [Spacing](float Location) {
+		const float Room = HALF_WORLD_MAX - FMath::Abs(Location) - Spacing;
+		return FMath::Clamp(FMath::FloorToInt(Room / Spacing) + 1, 1, MaxParkingSpotsPerAxis);
+	};
+
+	ParkingGridSize = FIntVector(GetNumberOfSpots(ParkingLocation.X), GetNumberOfSpots(ParkingLocation.Y), GetNumberOfSpots(ParkingLocation.Z));
+	ParkingGridStep = FVector(
+		ParkingLocation.X < 0.f ? -ParkingSpacing : ParkingSpacing,
+		ParkingLocation.Y < 0.f ? -ParkingSpacing : ParkingSpacing,
+		ParkingLocation.Z < 0.f ? -ParkingSpacing : ParkingSpacing);
+}
+
+void APoolHolder::RestoreDefaults(UObject* Object) {
+	if (!IsValid(Object)) return;
+
+	if (DefaultObjectSettings.bIsActor) {
+		RestoreActorSettings(CastChecked<AActor>(Object));
+	}
+	else {
+		ClassDefaults->Properties.RestoreDirty(Object);
 	}
 }
 
 void APoolHolder::RestoreActorSettings(AActor* Actor) {
+	SCOPE_CYCLE_COUNTER(STAT_PoolRestore);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	ON_SCOPE_EXIT {
+		Stats.RestoreCycles += FPlatformTime::Cycles64() - StartCycles;
+	};
+
 	// Restore default settings
 	Actor->SetActorTickInterval(DefaultObjectSettings.TickInterval);
 	Actor->bCanBeDamaged = DefaultObjectSettings.bCanBeDamaged;
-	if (DefaultObjectSettings.LifeSpan > 0) {
-		FTimerHandle* Timer = ObjectsToTimers.Find(Actor);
-		FTimerDelegate TimerDel;
-		TimerDel.BindUFunction(this, FName("ReturnObject"), Actor);
-		GetWorldTimerManager().SetTimer(*Timer, TimerDel, DefaultObjectSettings.LifeSpan, false);
-	}
-
-	// Restore default components settings
-	if (DefaultComponentsSettings.Num() > 0) {
-		TArray<UActorComponent*> ActorComponents;
-		Actor->GetComponents<UActorComponent>(ActorComponents);
 
-		for (int i = 0; i < ActorComponents.Num(); i++) {
-			if (i >= DefaultComponentsSettings.Num()) return;
+	ClassDefaults->Properties.RestoreDirty(Actor);
 
-			// Restore actor component settings
-			UActorComponent* ActorComponent = ActorComponents[i];
-			FDefaultComponentSettings ComponentSettings = DefaultComponentsSettings[i];
+	// Restore default components settings
+	for (const FDefaultComponentSettings& ComponentSettings : ClassDefaults->ComponentsSettings) {
+		// Components are owned by their actor, so the lookup by name is a single hash lookup
+		UActorComponent* ActorComponent = FindObjectFast<UActorComponent>(Actor, ComponentSettings.Name);
+		if (ActorComponent == nullptr) continue;
 
+		// Restore actor component settings
+		if (ActorComponent->IsComponentTickEnabled() != ComponentSettings.bStartWithTickEnabled) {
 			ActorComponent->SetComponentTickEnabled(ComponentSettings.bStartWithTickEnabled);
-			ActorComponent->SetComponentTickInterval(ComponentSettings.TickInterval);
+		}
+		ActorComponent->SetComponentTickInterval(ComponentSettings.TickInterval);
+		if (ActorComponent->ComponentTags != ComponentSettings.Tags) {
 			ActorComponent->ComponentTags = ComponentSettings.Tags;
-			ActorComponent->SetActive(ComponentSettings.bAutoActivate);
-
-			// Restore scene component settings
-			if (ComponentSettings.bIsSceneComponent) {
-				USceneComponent* SceneComponent = Cast<USceneComponent>(ActorComponent);
-				if (IsValid(SceneComponent)) {
-					if (i > 0) { // Skip the root transform
-						SceneComponent->SetRelativeTransform(ComponentSettings.RelativeTransform, false, nullptr, ETeleportType::TeleportPhysics);
-					}
-					SceneComponent->SetVisibility(ComponentSettings.bIsVisible);
-					SceneComponent->SetHiddenInGame(ComponentSettings.bIsHidden);
-
-					// Restore static mesh component settings
-					if (ComponentSettings.bIsStaticMeshComponent) {
-						UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(SceneComponent);
-						if (IsValid(StaticMeshComponent)) {
-							StaticMeshComponent->SetSimulatePhysics(ComponentSettings.bIsSimulatingPhysics);
-						}
+		}
+		ActorComponent->SetActive(ComponentSettings.bAutoActivate);
+		ComponentSettings.Properties.RestoreDirty(ActorComponent);
+
+		// Restore scene component settings
+		if (ComponentSettings.bIsSceneComponent) {
+			USceneComponent* SceneComponent = Cast<USceneComponent>(ActorComponent);
+			if (IsValid(SceneComponent)) {
+				// Skip the root transform
+				if (SceneComponent != Actor->GetRootComponent() && !SceneComponent->GetRelativeTransform().Equals(ComponentSettings.RelativeTransform)) {
+					SceneComponent->SetRelativeTransform(ComponentSettings.RelativeTransform, false, nullptr, ETeleportType::TeleportPhysics);
+				}
+				SceneComponent->SetVisibility(ComponentSettings.bIsVisible);
+				SceneComponent->SetHiddenInGame(ComponentSettings.bIsHidden);
+
+				// Restore static mesh component settings
+				if (ComponentSettings.bIsStaticMeshComponent) {
+					UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(SceneComponent);
+					if (IsValid(StaticMeshComponent) && StaticMeshComponent->IsSimulatingPhysics() != ComponentSettings.bIsSimulatingPhysics) {
+						StaticMeshComponent->SetSimulatePhysics(ComponentSettings.bIsSimulatingPhysics);
 					}
 				}
 			}
@@ -162,90 +917,274 @@ void APoolHolder::RestoreActorSettings(AActor* Actor) {
 }
 
 void APoolHolder::InitializePool(FPoolEntry PoolEntry) {
+	BeginInitializePool(PoolEntry);
+	WarmUp(TNumericLimits<double>::Max());
+}
+
+bool APoolHolder::WarmUp(double EndTime, int64 RemainingBudgetBytes) {
+	if (bIsWarmedUp) return true;
+
+	bool bIsOverBudget = false;
+	if (DefaultObjectSettings.Class) {
+		const int64 StartBytes = GetMemoryBytes();
+
+		// The objects are created inside the pool, they don't have to call PoolableEndPlay
+		bIsPoolHolderInitialized = false;
+		while (GetNumberOfObjects() < DesiredNumberOfObjects) {
+			// Check the budgets before every object, the size of the objects is only known after the first one has been measured
+			if (!CanGrow() || GetMemoryBytes() - StartBytes + BytesPerObject > RemainingBudgetBytes) {
+				bIsOverBudget = true;
+				break;
+			}
+
+			Add(CreateObject());
+
+			if (FPlatformTime::Seconds() >= EndTime) break;
+		}
+		bIsPoolHolderInitialized = true;
+	}
+
+	bIsWarmedUp = !DefaultObjectSettings.Class || bIsOverBudget || GetNumberOfObjects() >= DesiredNumberOfObjects;
+	return bIsWarmedUp;
+}
+
+void APoolHolder::BeginInitializePool(const FPoolEntry& PoolEntry) {
 	bIsPoolHolderInitialized = false;
+	bIsWarmedUp = false;
 	TSubclassOf<UObject> Class = PoolEntry.Class;
-	int32 NumberOfObjects = PoolEntry.AmountOfObjects;
+	DesiredNumberOfObjects = Class ? PoolEntry.AmountOfObjects : 0;
+	DeactivationStrategy = PoolEntry.DeactivationStrategy;
+	bBatchedUpdate = PoolEntry.bBatchedUpdate;
+	SetActorTickEnabled(bBatchedUpdate);
+	SizingPolicy = PoolEntry.SizingPolicy;
+	MemoryBudgetBytes = (int64)PoolEntry.MemoryBudgetKB * 1024;
+	BytesPerObject = 0;
+	Stats = FPoolStats();
+	ParkingLocation = PoolEntry.ParkingLocation;
+	ParkingSpacing = PoolEntry.ParkingSpacing;
+	InitializeParkingGrid();
+
+	TemplateActor = nullptr;
 
 	if (Class) {
-		// Save the default object settings
-		DefaultObjectSettings.bImplementsPoolableInterface = Class->ImplementsInterface(UPoolableInterface::StaticClass());
-		DefaultObjectSettings.Class = Class;
-
-		// Save the default actor settings
-		if (Class->IsChildOf(AActor::StaticClass())) {
-			AActor* DefaultActor = GetWorld()->SpawnActor(Class);
-			DefaultObjectSettings.bIsActor = true;
-			DefaultObjectSettings.bStartWithTickEnabled = DefaultActor->IsActorTickEnabled();
-			DefaultObjectSettings.TickInterval = DefaultActor->GetActorTickInterval();
-			DefaultObjectSettings.bHiddenInGame = DefaultActor->bHidden;
-			DefaultObjectSettings.LifeSpan = DefaultActor->InitialLifeSpan;
-			DefaultObjectSettings.bCanBeDamaged = DefaultActor->bCanBeDamaged;
-
-			// Save the default component settings
-			TArray<UActorComponent*> ActorComponents;
-			DefaultActor->GetComponents<UActorComponent>(ActorComponents);
-			for (int i = 0; i < ActorComponents.Num(); i++) {
-				FDefaultComponentSettings DefaultComponentSettings;
-				DefaultComponentSettings.bImplementsPoolableInterface = ActorComponents[i]->GetClass()->ImplementsInterface(UPoolableInterface::StaticClass());
-				DefaultComponentSettings.bStartWithTickEnabled = ActorComponents[i]->IsComponentTickEnabled();
-				DefaultComponentSettings.TickInterval = ActorComponents[i]->GetComponentTickInterval();
-				DefaultComponentSettings.Tags = ActorComponents[i]->ComponentTags;
-				DefaultComponentSettings.bAutoActivate = ActorComponents[i]->bAutoActivate;
-
-				// Check for scene component settings
-				USceneComponent* SceneComponent = Cast<USceneComponent>(ActorComponents[i]);
-				if (SceneComponent->IsValidLowLevelFast()) {
-					DefaultComponentSettings.bIsSceneComponent = true;
-					DefaultComponentSettings.RelativeTransform = SceneComponent->GetRelativeTransform();
-					DefaultComponentSettings.bIsVisible = SceneComponent->bVisible;
-					DefaultComponentSettings.bIsHidden = SceneComponent->bHiddenInGame;
-
-					// Check for static mesh component settings
-					UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(ActorComponents[i]);
-					if (StaticMeshComponent != nullptr) {
-						DefaultComponentSettings.bIsStaticMeshComponent = true;
-						DefaultComponentSettings.bIsSimulatingPhysics = StaticMeshComponent->IsSimulatingPhysics();
-					}
-				}
+#if CSV_PROFILER
+		CsvStatNameInUse = FName(*FString::Printf(TEXT("%s_InUse"), *Class->GetName()));
+		CsvStatNameAvailable = FName(*FString::Printf(TEXT("%s_Available"), *Class->GetName()));
+		CsvStatNameMisses = FName(*FString::Printf(TEXT("%s_Misses"), *Class->GetName()));
+#endif
 
-				DefaultComponentsSettings.Add(DefaultComponentSettings);
-			}
-			DefaultActor->Destroy();
+		// The settings are derived from the class default object once per class, no actor has to be spawned for it
+		ClassDefaults = FPoolClassDefaultsRegistry::Get(Class);
+		DefaultObjectSettings = ClassDefaults->ObjectSettings;
 
-			for (int i = 0; i < NumberOfObjects; i++) {
-				AActor* NewActor = GetWorld()->SpawnActor(Class);
-				Add(NewActor);
-			}
+		if (DefaultObjectSettings.bIsActor && PoolEntry.bCloneFromTemplate) {
+			CreateTemplateActor(Class);
 		}
-		else {
-			for (int i = 0; i < NumberOfObjects; i++) {
-				Add(NewObject<UObject>((UObject*)GetTransientPackage(), Class));
-			}
+
+		if (PoolEntry.InstancedMesh != nullptr) {
+			CreateInstancedMesh(PoolEntry);
 		}
 	}
 
 	bIsPoolHolderInitialized = true;
 }
 
+void APoolHolder::ResizePool(const FPoolEntry& PoolEntry) {
+	SizingPolicy = PoolEntry.SizingPolicy;
+	MemoryBudgetBytes = (int64)PoolEntry.MemoryBudgetKB * 1024;
+	DesiredNumberOfObjects = DefaultObjectSettings.Class ? PoolEntry.AmountOfObjects : 0;
+	LimitToMemoryBudget();
+
+	// A pool with an adaptive size shrinks on its own
+	NumberOfObjectsToShrink = SizingPolicy.bEnabled ? 0 : FMath::Max(GetNumberOfObjects() - DesiredNumberOfObjects, 0);
+	if (GetNumberOfObjects() < DesiredNumberOfObjects) {
+		bIsWarmedUp = false;
+	}
+}
+
+int32 APoolHolder::ShrinkToDesiredSize(double EndTime) {
+	if (NumberOfObjectsToShrink <= 0) return 0;
+
+	// The objects which are in use are destroyed after they have been returned
+	const int32 NumberOfDestroyedObjects = DestroyUnused(NumberOfObjectsToShrink, EndTime);
+	NumberOfObjectsToShrink = FMath::Max(FMath::Min(NumberOfObjectsToShrink - NumberOfDestroyedObjects, GetNumberOfObjects() - DesiredNumberOfObjects), 0);
+	return NumberOfDestroyedObjects;
+}
+
 int32 APoolHolder::GetNumberOfUsedObjects() {
-	return ObjectPool.Num() - AvailableObjects.Num();
+	return GetNumberOfObjects() - NumberOfAvailableObjects;
+}
+
+void APoolHolder::StoreSlotGenerations(TArray<uint8>& InOutGenerations) const {
+	if (InOutGenerations.Num() < Slots.Num()) {
+		InOutGenerations.SetNumZeroed(Slots.Num());
+	}
+	for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); SlotIndex++) {
+		InOutGenerations[SlotIndex] = Slots[SlotIndex].Generation;
+	}
+}
+
+bool APoolHolder::HasObjectsInUse() const {
+	for (int32 SlotIndex = FirstUsedSlot; SlotIndex != INDEX_NONE; SlotIndex = Slots[SlotIndex].Next) {
+		if (IsValid(Slots[SlotIndex].Object)) return true;
+	}
+	return false;
+}
+
+void APoolHolder::UpdateSize(float DeltaSeconds, double EndTime) {
+	if (!SizingPolicy.bEnabled || !DefaultObjectSettings.Class || !IsWarmedUp()) return;
+
+	const int32 DesiredAvailableObjects = FMath::Max(SizingPolicy.GrowthChunkSize, FMath::CeilToInt(GetNumberOfUsedObjects() * SizingPolicy.TargetHeadroomRatio));
+	const int32 LowWatermark = DesiredAvailableObjects / 2;
+	const int32 HighWatermark = DesiredAvailableObjects * 2;
+
+	if (NumberOfAvailableObjects < LowWatermark || (bIsGrowing && NumberOfAvailableObjects < DesiredAvailableObjects)) {
+		// Grow chunk by chunk before the pool runs empty, spread over multiple frames
+		TimeAboveHighWatermark = 0.f;
+		bIsGrowing = true;
+
+		bIsPoolHolderInitialized = false;
+		for (int i = 0; i < SizingPolicy.GrowthChunkSize && CanGrow(); i++) {
+			Add(CreateObject());
+
+			if (FPlatformTime::Seconds() >= EndTime) break;
+		}
+		bIsPoolHolderInitialized = true;
+
+		bIsGrowing = NumberOfAvailableObjects < DesiredAvailableObjects && CanGrow();
+	}
+	else if (NumberOfAvailableObjects > HighWatermark) {
+		// Only shrink after the demand has been low for a while and destroy a single chunk per update
+		TimeAboveHighWatermark += DeltaSeconds;
+		if (TimeAboveHighWatermark >= SizingPolicy.ShrinkCooldown) {
+			const int32 NumberOfRemovableObjects = FMath::Min(NumberOfAvailableObjects - DesiredAvailableObjects, GetNumberOfObjects() - SizingPolicy.MinObjects);
+			DestroyUnused(FMath::Min(NumberOfRemovableObjects, SizingPolicy.GrowthChunkSize), EndTime);
+		}
+	}
+	else {
+		TimeAboveHighWatermark = 0.f;
+	}
+}
+
+int64 APoolHolder::MeasureObjectBytes(UObject* Object) {
+	int64 Bytes = Object->GetClass()->GetStructureSize() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+
+	AActor* Actor = Cast<AActor>(Object);
+	if (Actor != nullptr) {
+		for (UActorComponent* Component : Actor->GetComponents()) {
+			if (Component != nullptr) {
+				Bytes += Component->GetClass()->GetStructureSize() + Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			}
+		}
+	}
+
+	return Bytes;
+}
+
+void APoolHolder::MeasureFirstObject(UObject* Object) {
+	if (Object == nullptr) return;
+
+	BytesPerObject = MeasureObjectBytes(Object);
+	LimitToMemoryBudget();
+}
+
+void APoolHolder::LimitToMemoryBudget() {
+	if (MemoryBudgetBytes > 0 && BytesPerObject > 0) {
+		DesiredNumberOfObjects = (int32)FMath::Min<int64>(DesiredNumberOfObjects, MemoryBudgetBytes / BytesPerObject);
+	}
+}
+
+int32 APoolHolder::TrimToMemoryBudget(double EndTime) {
+	if (MemoryBudgetBytes <= 0 || BytesPerObject <= 0) return 0;
+
+	const int64 ExcessBytes = GetMemoryBytes() - MemoryBudgetBytes;
+	if (ExcessBytes <= 0) return 0;
+
+	return DestroyUnused((int32)FMath::DivideAndRoundUp(ExcessBytes, BytesPerObject), EndTime);
+}
+
+int32 APoolHolder::DestroyUnused(int32 Quantity, double EndTime) {
+	int32 NumberOfDestroyedObjects = 0;
+	while (NumberOfDestroyedObjects < Quantity && LastFreeSlot != INDEX_NONE) {
+		DestroySlot(LastFreeSlot);
+		NumberOfDestroyedObjects++;
+
+		if (FPlatformTime::Seconds() >= EndTime) break;
+	}
+
+	return NumberOfDestroyedObjects;
+}
+
+void APoolHolder::DestroySlot(int32 SlotIndex) {
+	UObject* Object = Slots[SlotIndex].Object;
+	RetireSlot(SlotIndex);
+
+	if (IsValid(Object)) {
+		AActor* Actor = Cast<AActor>(Object);
+		if (Actor != nullptr) {
+			Actor->Destroy();
+		}
+		else {
+			Object->MarkPendingKill();
+		}
+	}
+}
+
+void APoolHolder::RetireSlot(int32 SlotIndex) {
+	FPoolSlot& Slot = Slots[SlotIndex];
+	if (Slot.bIsAvailable) {
+		UnlinkSlot(SlotIndex, FirstFreeSlot, LastFreeSlot);
+		NumberOfAvailableObjects--;
+	}
+	else {
+		UnlinkSlot(SlotIndex, FirstUsedSlot, LastUsedSlot);
+		if (Slot.BatchIndex != INDEX_NONE) {
+			RemoveBatchedIndex(Slot.BatchIndex);
+		}
+		ClearDeferredActivation(SlotIndex);
+	}
+
+	// A newer object might have taken over the keys already
+	const int32* KeySlotIndex = ObjectsToSlots.Find(Slot.Key);
+	if (KeySlotIndex != nullptr && *KeySlotIndex == SlotIndex) {
+		ObjectsToSlots.Remove(Slot.Key);
+	}
+	const int32* NameSlotIndex = NamesToSlots.Find(Slot.Name);
+	if (NameSlotIndex != nullptr && *NameSlotIndex == SlotIndex) {
+		NamesToSlots.Remove(Slot.Name);
+	}
+
+	Slot.Object = nullptr;
+	Slot.Key = nullptr;
+	Slot.Name = NAME_None;
+	Slot.bIsAvailable = false;
+	Slot.Generation++;
+	Slot.Next = FirstDeadSlot;
+	FirstDeadSlot = SlotIndex;
+	NumberOfDeadSlots++;
+}
+
+int32 APoolHolder::GetFirstValidFreeSlot() {
+	while (FirstFreeSlot != INDEX_NONE && !IsValid(Slots[FirstFreeSlot].Object)) {
+		RetireSlot(FirstFreeSlot);
+	}
+	return FirstFreeSlot;
 }
 
 int32 APoolHolder::GetNumberOfAvailableObjects() {
-	return AvailableObjects.Num();
+	return NumberOfAvailableObjects;
 }
 
 bool APoolHolder::IsObjectAvailable(UObject* Object) {
-	return AvailableObjects.Contains(Object->GetName());
+	const int32 SlotIndex = FindSlot(Object);
+	return SlotIndex != INDEX_NONE && Slots[SlotIndex].bIsAvailable;
 }
 
 void APoolHolder::Destroyed() {
 	if (DefaultObjectSettings.bIsActor) {
-		TArray<UObject*> Pool;
-		ObjectPool.GenerateValueArray(Pool);
-		for (auto& Object : Pool) {
-			AActor* Actor = Cast<AActor>(Object);
-			if (!Actor->IsPendingKill()) {
+		for (auto& Slot : Slots) {
+			AActor* Actor = Cast<AActor>(Slot.Object);
+			if (IsValid(Actor)) {
 				Actor->Destroy();
 			}
 		}
@@ -259,16 +1198,26 @@ void APoolHolder::Destroyed() {
 		}
 	}
 
-	AvailableObjects.Empty();
-
-	// Clear all timers
-	if (DefaultObjectSettings.LifeSpan > 0) {
-		TArray<FTimerHandle> TimerHandles;
-		ObjectsToTimers.GenerateValueArray(TimerHandles);
-		for (auto& Timer : TimerHandles) {
-			GetWorldTimerManager().ClearTimer(Timer);
-		}
+	if (TemplateActor != nullptr) {
+		TemplateActor->MarkPendingKill();
+		TemplateActor = nullptr;
 	}
 
+	Slots.Empty();
+	ObjectsToSlots.Empty();
+	NamesToSlots.Empty();
+	FirstFreeSlot = INDEX_NONE;
+	LastFreeSlot = INDEX_NONE;
+	NumberOfAvailableObjects = 0;
+	NumberOfDeferredActivations = 0;
+	FirstUsedSlot = INDEX_NONE;
+	LastUsedSlot = INDEX_NONE;
+	FirstDeadSlot = INDEX_NONE;
+	NumberOfDeadSlots = 0;
+
+	Instances.Initialize(PoolIndex);
+	PromotedActorsToInstances.Empty();
+	InstancesToPromotedActors.Empty();
+
 	Super::Destroyed();
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "PoolInstances.h"
+#include "Algo/Reverse.h"
+
+
+void FPoolInstanceSet::Initialize(int32 InPoolIndex) {
+	PoolIndex = InPoolIndex;
+	Transforms.Empty();
+	Payloads.Empty();
+	Generations.Empty();
+	States.Empty();
+	FreeInstances.Empty();
+	DirtyFlags.Empty();
+	DirtyInstances.Empty();
+	NumberOfActiveInstances = 0;
+	NumberOfPromotedInstances = 0;
+}
+
+void FPoolInstanceSet::Reserve(int32 NumberOfInstances) {
+	if (NumberOfInstances <= Num()) return;
+
+	Transforms.Reserve(NumberOfInstances);
+	Payloads.Reserve(NumberOfInstances);
+	Generations.Reserve(NumberOfInstances);
+	States.Reserve(NumberOfInstances);
+	FreeInstances.Reserve(NumberOfInstances);
+
+	// Push the new instances in reverse order, so the lowest index is reused first
+	const int32 FirstNewInstance = Num();
+	for (int32 i = FirstNewInstance; i < NumberOfInstances; i++) {
+		AddFreeInstance();
+	}
+	Algo::Reverse(FreeInstances.GetData() + FreeInstances.Num() - (NumberOfInstances - FirstNewInstance), NumberOfInstances - FirstNewInstance);
+}
+
+int32 FPoolInstanceSet::AddFreeInstance() {
+	const int32 InstanceIndex = Transforms.Add(FTransform::Identity);
+	Payloads.Add(FVector4(0.f, 0.f, 0.f, 0.f));
+	Generations.Add(0);
+	States.Add(EState::Free);
+	DirtyFlags.Add(false);
+	FreeInstances.Push(InstanceIndex);
+
+	// The instanced static mesh needs a hidden instance as well
+	MarkDirty(InstanceIndex);
+	return InstanceIndex;
+}
+
+FPoolInstanceHandle FPoolInstanceSet::Add(const FTransform& Transform, const FVector4& Payload) {
+	if (FreeInstances.Num() == 0) {
+		AddFreeInstance();
+	}
+
+	const int32 InstanceIndex = FreeInstances.Pop(false);
+	Transforms[InstanceIndex] = Transform;
+	Payloads[InstanceIndex] = Payload;
+	States[InstanceIndex] = EState::Active;
+	NumberOfActiveInstances++;
+	MarkDirty(InstanceIndex);
+
+	return FPoolInstanceHandle(PoolIndex, InstanceIndex, Generations[InstanceIndex]);
+}
+
+bool FPoolInstanceSet::Remove(FPoolInstanceHandle Handle) {
+	const int32 InstanceIndex = FindInstance(Handle);
+	if (InstanceIndex == INDEX_NONE) return false;
+
+	if (States[InstanceIndex] == EState::Active) {
+		NumberOfActiveInstances--;
+		MarkDirty(InstanceIndex);
+	}
+	else {
+		// A promoted instance is hidden already
+		NumberOfPromotedInstances--;
+	}
+
+	States[InstanceIndex] = EState::Free;
+	Generations[InstanceIndex]++;
+	FreeInstances.Push(InstanceIndex);
+	return true;
+}
+
+bool FPoolInstanceSet::Promote(FPoolInstanceHandle Handle) {
+	const int32 InstanceIndex = FindInstance(Handle);
+	if (InstanceIndex == INDEX_NONE || States[InstanceIndex] != EState::Active) return false;
+
+	States[InstanceIndex] = EState::Promoted;
+	NumberOfActiveInstances--;
+	NumberOfPromotedInstances++;
+	MarkDirty(InstanceIndex);
+	return true;
+}
+
+bool FPoolInstanceSet::Demote(FPoolInstanceHandle Handle, const FTransform& Transform) {
+	const int32 InstanceIndex = FindInstance(Handle);
+	if (InstanceIndex == INDEX_NONE || States[InstanceIndex] != EState::Promoted) return false;
+
+	States[InstanceIndex] = EState::Active;
+	Transforms[InstanceIndex] = Transform;
+	NumberOfPromotedInstances--;
+	NumberOfActiveInstances++;
+	MarkDirty(InstanceIndex);
+	return true;
+}
+
+FPoolInstanceSet::EState FPoolInstanceSet::GetState(FPoolInstanceHandle Handle) const {
+	const int32 InstanceIndex = FindInstance(Handle);
+	return InstanceIndex != INDEX_NONE ? States[InstanceIndex] : EState::Free;
+}
+
+bool FPoolInstanceSet::SetTransform(FPoolInstanceHandle Handle, const FTransform& Transform) {
+	const int32 InstanceIndex = FindInstance(Handle);
+	if (InstanceIndex == INDEX_NONE) return false;
+
+	Transforms[InstanceIndex] = Transform;
+	// The transform of a promoted instance is only remembered, its actor is rendered instead
+	if (States[InstanceIndex] == EState::Active) {
+		MarkDirty(InstanceIndex);
+	}
+	return true;
+}
+
+bool FPoolInstanceSet::GetTransform(FPoolInstanceHandle Handle, FTransform& OutTransform) const {
+	const int32 InstanceIndex = FindInstance(Handle);
+	if (InstanceIndex == INDEX_NONE) return false;
+
+	OutTransform = Transforms[InstanceIndex];
+	return true;
+}
+
+FVector4* FPoolInstanceSet::GetPayload(FPoolInstanceHandle Handle) {
+	const int32 InstanceIndex = FindInstance(Handle);
+	return InstanceIndex != INDEX_NONE ? &Payloads[InstanceIndex] : nullptr;
+}
+
+FTransform FPoolInstanceSet::GetRenderTransform(int32 InstanceIndex) const {
+	if (States[InstanceIndex] == EState::Active) {
+		return Transforms[InstanceIndex];
+	}
+
+	// Stay at the last location, so the bounds of the instanced static mesh don't grow
+	return FTransform(FQuat::Identity, Transforms[InstanceIndex].GetLocation(), FVector::ZeroVector);
+}
+
+void FPoolInstanceSet::ConsumeDirtyInstances(TArray<int32>& OutInstanceIndices) {
+	for (int32 InstanceIndex : DirtyInstances) {
+		DirtyFlags[InstanceIndex] = false;
+	}
+	// Swap the arrays, so both keep their allocations
+	Swap(OutInstanceIndices, DirtyInstances);
+	DirtyInstances.Reset();
+}
+
+int64 FPoolInstanceSet::GetAllocatedBytes() const {
+	return Transforms.GetAllocatedSize() + Payloads.GetAllocatedSize() + Generations.GetAllocatedSize() + States.GetAllocatedSize()
+		+ FreeInstances.GetAllocatedSize() + DirtyFlags.GetAllocatedSize() + DirtyInstances.GetAllocatedSize();
+}
+
+int32 FPoolInstanceSet::FindInstance(FPoolInstanceHandle Handle) const {
+	const int32 InstanceIndex = Handle.InstanceIndex;
+	if (Handle.PoolIndex != PoolIndex || !States.IsValidIndex(InstanceIndex)) return INDEX_NONE;
+	if (States[InstanceIndex] == EState::Free || Generations[InstanceIndex] != Handle.Generation) return INDEX_NONE;
+
+	return InstanceIndex;
+}
+
+void FPoolInstanceSet::MarkDirty(int32 InstanceIndex) {
+	if (!DirtyFlags[InstanceIndex]) {
+		DirtyFlags[InstanceIndex] = true;
+		DirtyInstances.Add(InstanceIndex);
+	}
+}
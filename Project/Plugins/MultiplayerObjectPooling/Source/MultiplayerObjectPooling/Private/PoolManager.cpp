@@ -3,15 +3,50 @@
 #include "PoolManager.h"
 #include "Engine.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Algo/StableSort.h"
 #include "PoolHolder.h"
+#include "ObjectPool.h"
+#include "BufferPool.h"
 
-APoolManager* APoolManager::Instance;
+TMap<const UWorld*, APoolManager*> APoolManager::WorldsToPoolManagers;
+TQueue<TWeakObjectPtr<UObject>, EQueueMode::Mpsc> APoolManager::DeferredReturns;
+
+namespace PoolManagerStats
+{
+	// The stats are shared by all worlds. The first pool manager which ticks in a frame starts the totals with the native pools,
+	// which exist once per process, every pool manager adds the pools of its own world
+	static uint64 FrameNumber = TNumericLimits<uint64>::Max();
+	static int32 NumberOfUsedObjects = 0;
+	static int32 NumberOfAvailableObjects = 0;
+	static int32 NumberOfActiveInstances = 0;
+	static int32 NumberOfPromotedInstances = 0;
+	static int64 MemoryBytes = 0;
+
+	static void BeginFrame() {
+		if (FrameNumber == GFrameCounter) return;
+		FrameNumber = GFrameCounter;
+
+		NumberOfUsedObjects = 0;
+		NumberOfAvailableObjects = 0;
+		NumberOfActiveInstances = 0;
+		NumberOfPromotedInstances = 0;
+		MemoryBytes = 0;
+		for (auto& ObjectPool : FObjectPoolBase::GetRegisteredPools()) {
+			ObjectPool->PublishStats();
+			NumberOfUsedObjects += ObjectPool->GetNumberOfUsedObjects();
+			NumberOfAvailableObjects += ObjectPool->GetNumberOfAvailableObjects();
+		}
+		SET_DWORD_STAT(STAT_PoolBufferBlocksInUse, FPoolBufferAllocator::GetNumberOfUsedBlocks());
+	}
+}
 
 // Sets default values
 APoolManager::APoolManager()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = false;
+	PrimaryActorTick.bCanEverTick = true;
+	// The deferred returns are processed once per frame after all the gameplay work is done
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
 
 	// Add a root component to stick the pool on the pool manager
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
@@ -21,130 +56,372 @@ APoolManager::APoolManager()
 void APoolManager::BeginPlay()
 {
 	Super::BeginPlay();
-	Instance = this;
+
+	APoolManager*& PoolManager = WorldsToPoolManagers.FindOrAdd(GetWorld());
+	if (PoolManager != nullptr && PoolManager != this) {
+		UE_LOG(LogTemp, Warning, TEXT("The world %s contains more than one pool manager, %s replaces %s!"), *GetWorld()->GetName(), *GetName(), *PoolManager->GetName());
+	}
+	PoolManager = this;
+	BindDataTable();
 	InitializePools();
 }
 
-APoolManager* APoolManager::GetPoolManager() {
-	return Instance;
+void APoolManager::Tick(float DeltaSeconds) {
+	Super::Tick(DeltaSeconds);
+	PoolManagerStats::BeginFrame();
+
+	if (bIsDataTableDirty) {
+		bIsDataTableDirty = false;
+		InitializePools();
+	}
+
+	UpdateStreamingLevelPools();
+
+	if (DeferredSpawnTransforms.Num() > 0) {
+		RemoveUnfinishedDeferredSpawns();
+	}
+
+	if (PoolsToWarmUp.Num() > 0) {
+		WarmUpPools();
+	}
+
+	if (PoolsToDrain.Num() > 0) {
+		DrainPools();
+	}
+
+	ReturnExpiredObjects();
+	ProcessDeferredReturns();
+	UpdatePoolSizes(DeltaSeconds);
+	TrimPools();
+
+	int32 NumberOfUsedObjects = 0;
+	int32 NumberOfAvailableObjects = 0;
+	int32 NumberOfActiveInstances = 0;
+	int32 NumberOfPromotedInstances = 0;
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder)) {
+			PoolHolder->PublishStats();
+			NumberOfUsedObjects += PoolHolder->GetNumberOfUsedObjects();
+			NumberOfAvailableObjects += PoolHolder->GetNumberOfAvailableObjects();
+
+			// Send all instance changes of this frame to the instanced meshes at once
+			if (PoolHolder->UsesInstances()) {
+				PoolHolder->FlushInstances();
+				NumberOfActiveInstances += PoolHolder->GetInstances().GetNumberOfActiveInstances();
+				NumberOfPromotedInstances += PoolHolder->GetInstances().GetNumberOfPromotedInstances();
+			}
+		}
+	}
+
+	// The stats show the sums of all worlds, the last pool manager of the frame sets the complete ones
+	PoolManagerStats::NumberOfUsedObjects += NumberOfUsedObjects;
+	PoolManagerStats::NumberOfAvailableObjects += NumberOfAvailableObjects;
+	PoolManagerStats::NumberOfActiveInstances += NumberOfActiveInstances;
+	PoolManagerStats::NumberOfPromotedInstances += NumberOfPromotedInstances;
+	SET_DWORD_STAT(STAT_PoolObjectsInUse, PoolManagerStats::NumberOfUsedObjects);
+	SET_DWORD_STAT(STAT_PoolObjectsAvailable, PoolManagerStats::NumberOfAvailableObjects);
+	SET_DWORD_STAT(STAT_PoolInstancesActive, PoolManagerStats::NumberOfActiveInstances);
+	SET_DWORD_STAT(STAT_PoolInstancesPromoted, PoolManagerStats::NumberOfPromotedInstances);
 }
 
-AActor* APoolManager::BeginDeferredSpawnFromPool(const UObject* WorldContextObject, UClass* Class, const FTransform& SpawnTransform, ESpawnActorCollisionHandlingMethod CollisionHandlingOverride, const bool Reconstruct, bool &SpawnSuccessful) {
-	//if (!ObjectPool->IsValidLowLevel() || ObjectPool->IsPendingKill()) {
-	if (!Class) {
-		return nullptr; 
-	}
-	//const auto &Settings = GetMutableDefault<UPoolSettings>();
-
-	//if (ObjectPool->Pool.Num() == 0) { 
-		//ObjectPool->InitializeObjectPool(); 
-	//}
-	//AActor* DeferredSpawn = ObjectPool->GetInactiveObject();
-	AActor* DeferredSpawn = Cast<AActor>(GetFromPool(Class, FSpawnParameter(), FSpecificSearch()));
-
-	if (DeferredSpawn == nullptr) {// && Settings->InstantiateOnDemand) {
-		//DeferredSpawn = Instance->GetWorld()->SpawnActorDeferred<AActor>(Class, SpawnTransform, Owner, ObjectPool->GetOwner()->GetInstigator(), CollisionHandlingOverride);
-		DeferredSpawn = Instance->GetWorld()->SpawnActorDeferred<AActor>(Class, SpawnTransform);
-		//if (DeferredSpawn) { 
-			//DeferredSpawn->OwningPool = ObjectPool; DeferredSpawn->FinishSpawning(SpawnTransform); 
-		//}
-	}/*
-	else if (DeferredSpawn == nullptr && Settings->NeverFailDeferredSpawn) {
-		DeferredSpawn = ObjectPool->GetSpawnedObject();
-		if (DeferredSpawn != nullptr) { 
-			DeferredSpawn->ReturnToPool(); 
-		}
-	} 
-	ObjectPool->FlushObjectPool();
-
-	if (DeferredSpawn != nullptr) {
-		const APawn* Instigator = Cast<APawn>(WorldContextObject);
-		if (Instigator == nullptr) { if (const AActor* ContextActor = Cast<AActor>(WorldContextObject)) { 
-			Instigator = ContextActor->Instigator; } 
-		}
-		if (Instigator != nullptr) { 
-			DeferredSpawn->Instigator = const_cast<APawn*>(Instigator); 
-		}
-		if (Owner == nullptr) { 
-			DeferredSpawn->SetOwner(ObjectPool->GetOwner()); 
-		}
-
-		DeferredSpawn->OwningPool = ObjectPool;
-		DeferredSpawn->Initialize();
-		DeferredSpawn->SpawnFromPool(Reconstruct, SpawnOptions, SpawnTransform);
-		SpawnSuccessful = DeferredSpawn->Spawned;
+void APoolManager::DumpStats(FOutputDevice& Ar, const FString& SortBy) const {
+	struct FPoolRow {
+		FString Name;
+		int32 NumberOfUsedObjects;
+		int32 NumberOfAvailableObjects;
+		int64 MemoryBytes;
+		const FPoolStats* Stats;
+	};
+
+	// The pool holders and the native object pools are listed together
+	TArray<FPoolRow> SortedPools;
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder)) {
+			SortedPools.Add({ PoolHolder->GetPoolClass()->GetName(), PoolHolder->GetNumberOfUsedObjects(), PoolHolder->GetNumberOfAvailableObjects(), PoolHolder->GetMemoryBytes(), &PoolHolder->GetStats() });
+		}
 	}
-	else {
-		SpawnSuccessful = false;
-		DeferredSpawn = ObjectPool->GetSpawnedObject();
-	} 
-	*/
-	
-	return DeferredSpawn;
+	for (auto& ObjectPool : FObjectPoolBase::GetRegisteredPools()) {
+		SortedPools.Add({ ObjectPool->GetPoolClass()->GetName() + TEXT(" (Native)"), ObjectPool->GetNumberOfUsedObjects(), ObjectPool->GetNumberOfAvailableObjects(), 0, &ObjectPool->GetStats() });
+	}
+
+	SortedPools.Sort([&SortBy](const FPoolRow& A, const FPoolRow& B) {
+		const FPoolStats& StatsA = *A.Stats;
+		const FPoolStats& StatsB = *B.Stats;
+		if (SortBy == TEXT("misses")) return StatsA.GetMisses() > StatsB.GetMisses();
+		if (SortBy == TEXT("peak")) return StatsA.PeakInUse > StatsB.PeakInUse;
+		if (SortBy == TEXT("creations")) return StatsA.OnDemandCreations > StatsB.OnDemandCreations;
+		if (SortBy == TEXT("memory")) return A.MemoryBytes > B.MemoryBytes;
+		if (SortBy == TEXT("time")) return StatsA.AcquireCycles + StatsA.ReleaseCycles > StatsB.AcquireCycles + StatsB.ReleaseCycles;
+		return StatsA.Acquires > StatsB.Acquires;
+	});
+
+	Ar.Logf(TEXT("%-40s %8s %8s %8s %10s %10s %10s %10s %8s %8s %8s %8s %10s %10s %10s %10s"),
+		TEXT("Class"), TEXT("InUse"), TEXT("Free"), TEXT("Peak"), TEXT("Mem(KB)"), TEXT("Acquires"), TEXT("Releases"), TEXT("Hits"),
+		TEXT("Ignored"), TEXT("Created"), TEXT("Added"), TEXT("Recycled"), TEXT("OnDemand"), TEXT("Acq(us)"), TEXT("Rel(us)"), TEXT("Rest(us)"));
+
+	for (auto& Row : SortedPools) {
+		const FPoolStats& Stats = *Row.Stats;
+		Ar.Logf(TEXT("%-40s %8d %8d %8d %10lld %10d %10d %10d %8d %8d %8d %8d %10d %10.2f %10.2f %10.2f"),
+			*Row.Name, Row.NumberOfUsedObjects, Row.NumberOfAvailableObjects, Stats.PeakInUse, Row.MemoryBytes / 1024,
+			Stats.Acquires, Stats.Releases, Stats.Hits, Stats.MissesIgnored, Stats.MissesCreated, Stats.MissesCreatedAndAdded, Stats.MissesRecycled, Stats.OnDemandCreations,
+			FPoolStats::GetAverageMicroseconds(Stats.AcquireCycles, Stats.Acquires),
+			FPoolStats::GetAverageMicroseconds(Stats.ReleaseCycles, Stats.Releases),
+			FPoolStats::GetAverageMicroseconds(Stats.RestoreCycles, Stats.Acquires));
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpPoolStatsCommand(
+	TEXT("Pool.DumpStats"),
+	TEXT("Prints the counters of all object pools and the buffer pool. Optional sort column: acquires (default), misses, peak, creations, memory, time"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar) {
+		APoolManager* PoolManager = APoolManager::GetPoolManager(World);
+		if (IsValid(PoolManager)) {
+			PoolManager->DumpStats(Ar, Args.Num() > 0 ? Args[0].ToLower() : FString());
+		}
+		else {
+			Ar.Log(TEXT("There is no pool manager."));
+		}
+
+		FPoolBufferAllocator::DumpStats(Ar);
+	})
+);
+
+APoolManager* APoolManager::GetPoolManager(const UObject* WorldContextObject) {
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	if (World == nullptr) return nullptr;
+
+	APoolManager** PoolManager = WorldsToPoolManagers.Find(World);
+	return PoolManager != nullptr && IsValid(*PoolManager) ? *PoolManager : nullptr;
 }
 
+// Apply the collision handling of SpawnActor to the spawn transform, returns false if the actor must not be spawned
+static bool AdjustSpawnTransform(UWorld* World, AActor* DefaultActor, ESpawnActorCollisionHandlingMethod CollisionHandlingMethod, FTransform& SpawnTransform) {
+	switch (CollisionHandlingMethod) {
+	case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn:
+	case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding:
+	{
+		FVector Location = SpawnTransform.GetLocation();
+		if (World->FindTeleportSpot(DefaultActor, Location, SpawnTransform.Rotator())) {
+			SpawnTransform.SetLocation(Location);
+			return true;
+		}
+		return CollisionHandlingMethod == ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	}
+
+	case ESpawnActorCollisionHandlingMethod::DontSpawnIfColliding:
+		return !World->EncroachingBlockingGeometry(DefaultActor, SpawnTransform.GetLocation(), SpawnTransform.Rotator());
+
+	default:
+		return true;
+	}
+}
+
+AActor* APoolManager::BeginDeferredSpawnFromPool(const UObject* WorldContextObject, UClass* Class, const FTransform& SpawnTransform, ESpawnActorCollisionHandlingMethod CollisionHandlingOverride, const bool Reconstruct, bool &SpawnSuccessful) {
+	SpawnSuccessful = false;
+	if (Class == nullptr || !Class->IsChildOf(AActor::StaticClass())) {
+		UE_LOG(LogTemp, Error, TEXT("Pass a valid class in BeginDeferredSpawnFromPool which inherits from Actor!"));
+		return nullptr;
+	}
+
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	if (World == nullptr) return nullptr;
+
+	APoolManager* PoolManager = GetPoolManager(World);
+	APoolHolder** PoolHolder = PoolManager != nullptr && PoolManager->IsPoolManagerReady() ? PoolManager->ClassesToPools.Find(Class) : nullptr;
+	if (PoolHolder == nullptr || !IsValid(*PoolHolder)) {
+		// The class isn't pooled, spawn the actor like SpawnActorDeferred
+		AActor* Actor = World->SpawnActorDeferred<AActor>(Class, SpawnTransform, nullptr, nullptr, CollisionHandlingOverride);
+		SpawnSuccessful = Actor != nullptr;
+		return Actor;
+	}
+
+	// Test the spawn location with the default object, the same way SpawnActor does
+	AActor* DefaultActor = Class->GetDefaultObject<AActor>();
+	const ESpawnActorCollisionHandlingMethod CollisionHandlingMethod = CollisionHandlingOverride != ESpawnActorCollisionHandlingMethod::Undefined ? CollisionHandlingOverride : DefaultActor->SpawnCollisionHandlingMethod;
+	FTransform AdjustedTransform = SpawnTransform;
+	if (!AdjustSpawnTransform(World, DefaultActor, CollisionHandlingMethod, AdjustedTransform)) return nullptr;
+
+	// The actor stays deactivated until FinishDeferredSpawnFromPool, an empty pool grows like with CreateAndAdd
+	FSpawnParameter SpawnParameter;
+	SpawnParameter.bSetActive = false;
+	SpawnParameter.HandleEmptyPool = EHandleEmptyPool::CREATE_AND_ADD;
+	AActor* Actor = Cast<AActor>(AcquireFromPoolHolder(*PoolHolder, SpawnParameter));
+	if (Actor == nullptr) return nullptr;
+
+	// Restore the defaults before the caller configures the actor, so its values survive the activation
+	(*PoolHolder)->RestoreDefaults(Actor);
+	(*PoolHolder)->BeginDeferredActivation(Actor);
+
+	Actor->SetActorTransform(AdjustedTransform, false, nullptr, ETeleportType::TeleportPhysics);
+
+	// The blueprint construction graph isn't run again, its components would pile up with every reuse. Only the native hook is called on request
+	if (Reconstruct) {
+		Actor->OnConstruction(AdjustedTransform);
+	}
+	if (!AdjustedTransform.Equals(SpawnTransform)) {
+		PoolManager->DeferredSpawnTransforms.Add(Actor, AdjustedTransform);
+	}
+
+	SpawnSuccessful = true;
+	return Actor;
+}
 
 AActor* APoolManager::FinishDeferredSpawnFromPool(AActor* Actor, const FTransform& SpawnTransform) {
-	if (Actor->IsValidLowLevel() && !Actor->IsActorInitialized() && !Actor->IsPendingKill()) {
+	if (!IsValid(Actor)) return nullptr;
+
+	// Actors of classes without a pool have been spawned deferred
+	if (!Actor->IsActorInitialized()) {
 		Actor->FinishSpawning(SpawnTransform);
-	} return Actor;
+		return Actor;
+	}
+
+	APoolManager* PoolManager = GetPoolManager(Actor);
+	APoolHolder** PoolHolder = PoolManager != nullptr ? PoolManager->ClassesToPools.Find(Actor->GetClass()) : nullptr;
+	if (PoolHolder == nullptr || !IsValid(*PoolHolder)) return Actor;
+
+	// Keep the location which has been adjusted by the collision handling
+	FTransform FinalTransform = SpawnTransform;
+	PoolManager->DeferredSpawnTransforms.RemoveAndCopyValue(Actor, FinalTransform);
+
+	// The actor has already been activated or returned since the deferred spawn began
+	if (!(*PoolHolder)->FinishDeferredActivation(Actor)) return Actor;
+
+	if (!Actor->GetActorTransform().Equals(FinalTransform)) {
+		Actor->SetActorTransform(FinalTransform, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	(*PoolHolder)->SetObjectActive(Actor, true, false);
+	return Actor;
 }
 
+UObject* APoolManager::GetFromPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	if (PoolManager == nullptr) return nullptr;
 
-UObject* APoolManager::GetFromPool(TSubclassOf<UObject> Class, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch) {
 	APoolHolder* PoolHolder;
-	if (Instance->GetPoolHolder(Class, PoolHolder)) {
-		if (PoolHolder->IsValidLowLevel()) {
-			FString SpecificActor = SpecificSearch.SpecificActor;
-			bool bReturnSpecificActor = SpecificActor.Len() > 0;
+	if (PoolManager->GetPoolHolder(Class, PoolHolder)) {
+		return AcquireFromPoolHolder(PoolHolder, SpawnParameter, &SpecificSearch);
+	}
+	
+	return nullptr;
+}
 
-			UObject* UnusedObject;
-			if (bReturnSpecificActor) {
-				UnusedObject = PoolHolder->GetSpecific(SpecificActor);
+FPoolHandle APoolManager::GetPoolHandle(const UObject* WorldContextObject, TSubclassOf<UObject> Class) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	APoolHolder* PoolHolder;
+	if (PoolManager != nullptr && PoolManager->GetPoolHolder(Class, PoolHolder)) {
+		return FPoolHandle(PoolManager, PoolManager->Pools.Find(PoolHolder), PoolManager->PoolGeneration);
+	}
 
-				if (SpecificSearch.HandleNoSpecificFound == EHandleNoSpecificFound::NEXT_FREE && !UnusedObject->IsValidLowLevel()) {
-					UnusedObject = PoolHolder->GetUnused();
-				}
+	return FPoolHandle();
+}
+
+UObject* APoolManager::GetFromPoolByHandle(FPoolHandle Handle, FSpawnParameter SpawnParameter) {
+	return AcquireFromPoolHolder(ResolvePoolHandle(Handle), SpawnParameter);
+}
+
+UObject* APoolManager::AcquireFromPoolHolder(APoolHolder* PoolHolder, const FSpawnParameter& SpawnParameter, const FSpecificSearch* SpecificSearch) {
+	if (!IsValid(PoolHolder)) return nullptr;
+
+	SCOPE_CYCLE_COUNTER(STAT_PoolAcquire);
+	INC_DWORD_STAT(STAT_PoolAcquires);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	FPoolStats& Stats = PoolHolder->GetMutableStats();
+	Stats.Acquires++;
+
+	UObject* UnusedObject;
+	if (SpecificSearch != nullptr && (SpecificSearch->SpecificId.IsValid() || SpecificSearch->SpecificActor.Len() > 0)) {
+		if (SpecificSearch->SpecificId.IsValid()) {
+			UnusedObject = PoolHolder->GetSpecific(SpecificSearch->SpecificId);
+		}
+		else {
+			UnusedObject = PoolHolder->GetSpecific(SpecificSearch->SpecificActor);
+		}
+
+		if (SpecificSearch->HandleNoSpecificFound == EHandleNoSpecificFound::NEXT_FREE && UnusedObject == nullptr) {
+			UnusedObject = PoolHolder->GetUnused();
+		}
+	}
+	else {
+		UnusedObject = PoolHolder->GetUnused();
+	}
+
+	if (UnusedObject == nullptr) {
+		INC_DWORD_STAT(STAT_PoolMisses);
+
+		if (!PoolHolder->IsWarmedUp()) {
+			// The pool is still warming up, create the object on demand and count it towards the warm up
+			UnusedObject = PoolHolder->GetNew();
+			if (UnusedObject != nullptr) {
+				Stats.MissesCreatedAndAdded++;
 			}
 			else {
-				UnusedObject = PoolHolder->GetUnused();
+				Stats.MissesIgnored++;
 			}
-
-			if (UnusedObject == nullptr) {
-				if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE) {
-					if (Class->IsChildOf(AActor::StaticClass())) {
-						UnusedObject = Instance->GetWorld()->SpawnActor(Class);
-					}
-					else {
-						UnusedObject = NewObject<UObject>((UObject*)GetTransientPackage(), Class);
-					}
-				}
-				else if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE_AND_ADD) {
-					UnusedObject = PoolHolder->GetNew();
-				}
+		}
+		else if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE) {
+			UClass* Class = PoolHolder->GetPoolClass();
+			if (Class->IsChildOf(AActor::StaticClass())) {
+				UnusedObject = PoolHolder->GetWorld()->SpawnActor(Class);
 			}
-
-			if (SpawnParameter.bSetActive) {
-				PoolHolder->SetObjectActive(UnusedObject);
+			else {
+				UnusedObject = NewObject<UObject>(PoolHolder, Class);
 			}
+			Stats.MissesCreated++;
+		}
+		else if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE_AND_ADD) {
+			// Nothing is created if the pool has reached its maximum size or its memory budget
+			UnusedObject = PoolHolder->GetNew();
+			if (UnusedObject != nullptr) {
+				Stats.MissesCreatedAndAdded++;
+			}
+			else {
+				Stats.MissesIgnored++;
+			}
+		}
+		else if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::RECYCLE_OLDEST) {
+			// Nothing is recycled if all used objects have been destroyed by the gameplay
+			UnusedObject = PoolHolder->RecycleOldest();
+			if (UnusedObject != nullptr) {
+				Stats.MissesRecycled++;
+			}
+			else {
+				Stats.MissesIgnored++;
+			}
+		}
+		else {
+			Stats.MissesIgnored++;
+		}
 
-			return UnusedObject;
+		if (UnusedObject != nullptr && SpawnParameter.HandleEmptyPool != EHandleEmptyPool::RECYCLE_OLDEST) {
+			Stats.OnDemandCreations++;
+			INC_DWORD_STAT(STAT_PoolOnDemandCreations);
 		}
 	}
-	
-	return nullptr;
+
+	if (SpawnParameter.bSetActive) {
+		PoolHolder->SetObjectActive(UnusedObject);
+	}
+
+	Stats.AcquireCycles += FPlatformTime::Cycles64() - StartCycles;
+	return UnusedObject;
 }
 
 bool APoolManager::GetPoolHolder(TSubclassOf<UObject> Class, APoolHolder*& PoolHolder) {
 	if (Class) {
 		if (IsPoolManagerReady()) {
-			FString Key = Class->GetName();
-			if (ClassNamesToPools.Contains(Key)) {
-				PoolHolder = *ClassNamesToPools.Find(Key);
+			APoolHolder** FoundPoolHolder = ClassesToPools.Find(Class);
+			if (FoundPoolHolder != nullptr) {
+				PoolHolder = *FoundPoolHolder;
+				return true;
+			}
+			else if (const int32* PendingPoolIndex = PendingPools.Num() > 0 ? PendingPools.Find(FSoftObjectPath(Class.Get())) : nullptr) {
+				// The class is loaded because it is passed in, create the pool on demand
+				PoolHolder = InitializePendingPool(*PendingPoolIndex, Class);
 				return true;
 			}
 			else {
-				UE_LOG(LogTemp, Error, TEXT("Pool Manager doesn't contain the class %s!"), *Key);
+				UE_LOG(LogTemp, Error, TEXT("Pool Manager doesn't contain the class %s!"), *Class->GetPathName());
 				return false;
 			}
 		}
@@ -158,21 +435,90 @@ bool APoolManager::GetPoolHolder(TSubclassOf<UObject> Class, APoolHolder*& PoolH
 	return false;
 }
 
-TArray<UObject*> APoolManager::GetXFromPool(TSubclassOf<UObject> Class, int32 Quantity) {
+TArray<UObject*> APoolManager::GetXFromPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class, int32 Quantity) {
 	TArray<UObject*> Objects;
-	for (int i = 0; i < Quantity; i++) {
-		UObject* Object = GetFromPool(Class, FSpawnParameter(), FSpecificSearch());
-		if (Object->IsValidLowLevel()) break;
-		
-		Objects.Add(Object);
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	APoolHolder* PoolHolder;
+	if (PoolManager != nullptr && PoolManager->GetPoolHolder(Class, PoolHolder)) {
+		AcquireFromPoolHolder(PoolHolder, Quantity, Objects, FSpawnParameter());
 	}
 
 	return Objects;
 }
 
-TArray<UObject*> APoolManager::GetAllFromPool(TSubclassOf<UObject> Class) {
+int32 APoolManager::AcquireFromPoolHolder(APoolHolder* PoolHolder, int32 Quantity, TArray<UObject*>& OutObjects, const FSpawnParameter& SpawnParameter) {
+	if (!IsValid(PoolHolder) || Quantity <= 0) return 0;
+
+	SCOPE_CYCLE_COUNTER(STAT_PoolAcquire);
+	INC_DWORD_STAT_BY(STAT_PoolAcquires, Quantity);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	FPoolStats& Stats = PoolHolder->GetMutableStats();
+	Stats.Acquires += Quantity;
+
+	const int32 NumberOfObjects = OutObjects.Num();
+	const int32 NumberOfAvailableObjects = PoolHolder->GetNumberOfAvailableObjects();
+	const int32 NumberOfMisses = FMath::Max(Quantity - NumberOfAvailableObjects, 0);
+	const bool bGrow = SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE_AND_ADD || !PoolHolder->IsWarmedUp();
+
+	// Only the objects which were in use before can be recycled, not the ones of this request, so they are recycled first
+	int32 NumberOfRecycledObjects = 0;
+	if (!bGrow && SpawnParameter.HandleEmptyPool == EHandleEmptyPool::RECYCLE_OLDEST && NumberOfMisses > 0) {
+		NumberOfRecycledObjects = PoolHolder->RecycleOldest(NumberOfMisses, OutObjects);
+	}
+	const int32 NumberOfAcquiredObjects = PoolHolder->GetUnused(Quantity - NumberOfRecycledObjects, OutObjects, bGrow);
+
+	if (NumberOfMisses > 0) {
+		INC_DWORD_STAT_BY(STAT_PoolMisses, NumberOfMisses);
+		if (bGrow) {
+			// The pool only grows up to its maximum size and its memory budget
+			const int32 NumberOfCreatedObjects = NumberOfAcquiredObjects - FMath::Min(Quantity, NumberOfAvailableObjects);
+			Stats.MissesCreatedAndAdded += NumberOfCreatedObjects;
+			Stats.MissesIgnored += NumberOfMisses - NumberOfCreatedObjects;
+			Stats.OnDemandCreations += NumberOfCreatedObjects;
+			INC_DWORD_STAT_BY(STAT_PoolOnDemandCreations, NumberOfCreatedObjects);
+		}
+		else if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE) {
+			Stats.MissesCreated += NumberOfMisses;
+		}
+		else if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::RECYCLE_OLDEST) {
+			Stats.MissesRecycled += NumberOfRecycledObjects;
+			Stats.MissesIgnored += NumberOfMisses - NumberOfRecycledObjects;
+		}
+		else {
+			Stats.MissesIgnored += NumberOfMisses;
+		}
+		if (!bGrow && SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE) {
+			Stats.OnDemandCreations += NumberOfMisses;
+			INC_DWORD_STAT_BY(STAT_PoolOnDemandCreations, NumberOfMisses);
+		}
+	}
+
+	if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE) {
+		UClass* Class = PoolHolder->GetPoolClass();
+		while (OutObjects.Num() - NumberOfObjects < Quantity) {
+			if (Class->IsChildOf(AActor::StaticClass())) {
+				OutObjects.Add(PoolHolder->GetWorld()->SpawnActor(Class));
+			}
+			else {
+				OutObjects.Add(NewObject<UObject>(PoolHolder, Class));
+			}
+		}
+	}
+
+	if (SpawnParameter.bSetActive) {
+		for (int i = NumberOfObjects; i < OutObjects.Num(); i++) {
+			PoolHolder->SetObjectActive(OutObjects[i]);
+		}
+	}
+
+	Stats.AcquireCycles += FPlatformTime::Cycles64() - StartCycles;
+	return OutObjects.Num() - NumberOfObjects;
+}
+
+TArray<UObject*> APoolManager::GetAllFromPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
 	APoolHolder* PoolHolder;
-	if (Instance->GetPoolHolder(Class, PoolHolder)) {
+	if (PoolManager != nullptr && PoolManager->GetPoolHolder(Class, PoolHolder)) {
 		if (PoolHolder->IsValidLowLevel()) {
 			return PoolHolder->GetAllUnused();
 		}
@@ -183,19 +529,22 @@ TArray<UObject*> APoolManager::GetAllFromPool(TSubclassOf<UObject> Class) {
 
 void APoolManager::SetPoolObjectActive(UObject* Object, bool bSetActive) {
 	if (!Object->IsValidLowLevel()) return;
-	if (!IsPoolManagerReady()) return;
+
+	// The pooled objects belong to the pool manager of their world
+	APoolManager* PoolManager = GetPoolManager(Object);
+	if (PoolManager == nullptr || !PoolManager->IsPoolManagerReady()) return;
 
 	APoolHolder* PoolHolder;
-	if (Instance->GetPoolHolder(Object->GetClass(), PoolHolder)) {
+	if (PoolManager->GetPoolHolder(Object->GetClass(), PoolHolder)) {
 		if (PoolHolder->IsValidLowLevel()) {
 			PoolHolder->SetObjectActive(Object, bSetActive);
 		}
 	}
 }
 
-AActor* APoolManager::SpawnActorFromPool(TSubclassOf<AActor> Class, FTransform SpawnTransform, AActor* PoolOwner, APawn* PoolInstigator, EBranch& Branch, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch) {
+AActor* APoolManager::SpawnActorFromPool(const UObject* WorldContextObject, TSubclassOf<AActor> Class, FTransform SpawnTransform, AActor* PoolOwner, APawn* PoolInstigator, EBranch& Branch, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch) {
 	if (Class) {
-		AActor* UnusedActor = Cast<AActor>(GetFromPool(Class, SpawnParameter, SpecificSearch));
+		AActor* UnusedActor = Cast<AActor>(GetFromPool(WorldContextObject, Class, SpawnParameter, SpecificSearch));
 
 		if (!UnusedActor->IsValidLowLevel()) {
 			Branch = EBranch::Failed;
@@ -215,50 +564,750 @@ AActor* APoolManager::SpawnActorFromPool(TSubclassOf<AActor> Class, FTransform S
 	return nullptr;
 }
 
+void APoolManager::SpawnActorsFromPool(const UObject* WorldContextObject, TSubclassOf<AActor> Class, const TArray<FTransform>& SpawnTransforms, AActor* PoolOwner, APawn* PoolInstigator, TArray<AActor*>& OutActors, EBranch& Branch, FSpawnParameter SpawnParameter) {
+	OutActors.Reset();
+	Branch = EBranch::Failed;
+
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	APoolHolder* PoolHolder;
+	if (!Class || PoolManager == nullptr || !PoolManager->GetPoolHolder(Class, PoolHolder)) {
+		UE_LOG(LogTemp, Error, TEXT("Pass a valid pooled class in SpawnActorsFromPool which inherits from Actor!"));
+		return;
+	}
+
+	// Take all actors first and activate them after they have been moved to their spawn transforms
+	TArray<UObject*> Objects;
+	const bool bSetActive = SpawnParameter.bSetActive;
+	SpawnParameter.bSetActive = false;
+	AcquireFromPoolHolder(PoolHolder, SpawnTransforms.Num(), Objects, SpawnParameter);
+
+	OutActors.Reserve(Objects.Num());
+	for (int i = 0; i < Objects.Num(); i++) {
+		AActor* Actor = CastChecked<AActor>(Objects[i]);
+		Actor->SetActorTransform(SpawnTransforms[i], false, nullptr, ETeleportType::TeleportPhysics);
+		Actor->SetOwner(PoolOwner);
+		Actor->Instigator = PoolInstigator;
+		OutActors.Add(Actor);
+	}
+
+	if (bSetActive) {
+		for (auto& Actor : OutActors) {
+			PoolHolder->SetObjectActive(Actor);
+		}
+	}
+
+	if (OutActors.Num() == SpawnTransforms.Num()) {
+		Branch = EBranch::Success;
+	}
+}
+
 void APoolManager::InitializePools() {
-	DestroyAllPools();
+	bIsInitialized = false;
 
 	FString Context;
-	TArray<FPoolEntry*> PoolEntries;
-	DataTable->GetAllRows<FPoolEntry>(Context, PoolEntries);
+	TArray<FPoolEntry*> TableEntries;
+	if (DataTable != nullptr) {
+		DataTable->GetAllRows<FPoolEntry>(Context, TableEntries);
+	}
+
+	// Pools with a higher priority are created and warmed up first, the table order is kept for equal priorities
+	Algo::StableSort(TableEntries, [](const FPoolEntry* A, const FPoolEntry* B) {
+		return A->WarmUpPriority > B->WarmUpPriority;
+	});
+
+	// The existing pools of the data table are matched by their class, so the unchanged pools keep their objects
+	TMultiMap<FSoftObjectPath, int32> ExistingPools;
+	for (int32 PoolIndex = 0; PoolIndex < PoolEntries.Num(); PoolIndex++) {
+		if (DataTablePools[PoolIndex]) {
+			ExistingPools.Add(GetPoolClassPath(PoolEntries[PoolIndex]), PoolIndex);
+		}
+	}
+
+	for (auto& PoolEntry : TableEntries) {
+		const FSoftObjectPath ClassPath = GetPoolClassPath(*PoolEntry);
+		const int32* ExistingPoolIndex = ExistingPools.Find(ClassPath);
+		if (ExistingPoolIndex != nullptr) {
+			const int32 PoolIndex = *ExistingPoolIndex;
+			ExistingPools.RemoveSingle(ClassPath, PoolIndex);
+			UpdatePool(PoolIndex, *PoolEntry);
+			continue;
+		}
+
+		const int32 PoolIndex = AddPoolEntry(*PoolEntry);
+		DataTablePools[PoolIndex] = true;
+
+		if (PoolEntry->IsLevelScoped()) {
+			AddStreamingLevelPool(PoolIndex);
+		}
+		else {
+			CreatePool(PoolIndex);
+		}
+	}
 
-	for (auto& PoolEntry : PoolEntries) {
-		FPoolEntry Entry = *PoolEntry;
-		InitializeObjectPool(Entry);
+	// The classes which have been removed from the data table, their indices are never used again
+	for (auto& ExistingPool : ExistingPools) {
+		RemovePool(ExistingPool.Value);
+		RetiredSlotGenerations.Remove(ExistingPool.Value);
 	}
 
+	// The pools of the levels which are loaded from the start are warmed up with the other pools
+	UpdateStreamingLevelPools();
+
+	// The pools can be used while they are warming up, missing objects are created on demand
 	bIsReady = true;
-	OnInitialized.Broadcast();
+
+	if (bTimeSlicedWarmUp) {
+		WarmUpPools();
+	}
+	else {
+		for (auto& PoolHolder : PoolsToWarmUp) {
+			PoolHolder->WarmUp(TNumericLimits<double>::Max(), GetRemainingMemoryBytes());
+			OnPoolReady.Broadcast(PoolHolder->GetPoolClass());
+		}
+		PoolsToWarmUp.Empty();
+		bIsInitialized = true;
+		OnInitialized.Broadcast();
+	}
+}
+
+FSoftObjectPath APoolManager::GetPoolClassPath(const FPoolEntry& PoolEntry) {
+	return PoolEntry.UsesSoftClass() ? PoolEntry.SoftClass.ToSoftObjectPath() : FSoftObjectPath(PoolEntry.Class);
+}
+
+void APoolManager::UpdatePool(int32 PoolIndex, const FPoolEntry& PoolEntry) {
+	FPoolEntry& CurrentPoolEntry = PoolEntries[PoolIndex];
+	const UScriptStruct* PoolEntryStruct = FPoolEntry::StaticStruct();
+	if (PoolEntryStruct->CompareScriptStruct(&CurrentPoolEntry, &PoolEntry, PPF_None)) return;
+
+	// Check if only the sizes differ
+	FPoolEntry ResizedPoolEntry = CurrentPoolEntry;
+	ResizedPoolEntry.AmountOfObjects = PoolEntry.AmountOfObjects;
+	ResizedPoolEntry.WarmUpPriority = PoolEntry.WarmUpPriority;
+	ResizedPoolEntry.SizingPolicy = PoolEntry.SizingPolicy;
+	ResizedPoolEntry.MemoryBudgetKB = PoolEntry.MemoryBudgetKB;
+	if (PoolEntryStruct->CompareScriptStruct(&ResizedPoolEntry, &PoolEntry, PPF_None)) {
+		const bool bIsPriorityChanged = CurrentPoolEntry.WarmUpPriority != PoolEntry.WarmUpPriority;
+		CurrentPoolEntry = PoolEntry;
+
+		// Pools which haven't been created yet use the new entry as soon as they are created
+		APoolHolder* PoolHolder = Pools[PoolIndex];
+		if (IsValid(PoolHolder)) {
+			PoolHolder->ResizePool(PoolEntry);
+
+			// The pools of unloaded levels are filled again when their level is loaded
+			if (!PoolHolder->IsWarmedUp() && !PoolsToDrain.Contains(PoolHolder)) {
+				PoolsToWarmUp.AddUnique(PoolHolder);
+			}
+		}
+
+		if (bIsPriorityChanged) {
+			SortPoolsToWarmUp();
+		}
+		return;
+	}
+
+	// Every other setting is baked into the pool holder, the pool is rebuilt at the same index to keep its handles valid
+	RemovePool(PoolIndex);
+	PoolEntries[PoolIndex] = PoolEntry;
+	DataTablePools[PoolIndex] = true;
+
+	if (PoolEntry.IsLevelScoped()) {
+		AddStreamingLevelPool(PoolIndex);
+	}
+	else {
+		CreatePool(PoolIndex);
+	}
+}
+
+void APoolManager::RemovePool(int32 PoolIndex) {
+	const FPoolEntry& PoolEntry = PoolEntries[PoolIndex];
+	if (PoolEntry.UsesSoftClass()) {
+		PendingPools.Remove(PoolEntry.SoftClass.ToSoftObjectPath());
+	}
+
+	TSharedPtr<FStreamableHandle>& StreamingHandle = PoolStreamingHandles[PoolIndex];
+	if (StreamingHandle.IsValid()) {
+		if (StreamingHandle->IsLoadingInProgress()) {
+			StreamingHandle->CancelHandle();
+		}
+		else {
+			StreamingHandle->ReleaseHandle();
+		}
+		StreamingHandle.Reset();
+	}
+
+	for (auto& LevelPools : StreamingLevelPools) {
+		LevelPools.PoolIndices.Remove(PoolIndex);
+	}
+
+	// The used objects are still a part of the gameplay, the pool is drained like the pools of unloaded levels
+	APoolHolder* PoolHolder = Pools[PoolIndex];
+	if (IsValid(PoolHolder)) {
+		PoolsToWarmUp.Remove(PoolHolder);
+		PoolsToDrain.AddUnique(PoolHolder);
+
+		APoolHolder** ClassPoolHolder = ClassesToPools.Find(PoolHolder->GetPoolClass());
+		if (ClassPoolHolder != nullptr && *ClassPoolHolder == PoolHolder) {
+			ClassesToPools.Remove(PoolHolder->GetPoolClass());
+		}
+
+		RetireSlotGenerations(PoolHolder);
+	}
+	Pools[PoolIndex] = nullptr;
+
+	// The entry doesn't match any class anymore
+	PoolEntries[PoolIndex] = FPoolEntry();
+	PoolEntries[PoolIndex].Class = nullptr;
+	DataTablePools[PoolIndex] = false;
+}
+
+void APoolManager::SortPoolsToWarmUp() {
+	PoolsToWarmUp.RemoveAll([](const APoolHolder* PoolHolder) {
+		return !IsValid(PoolHolder);
+	});
+	Algo::StableSort(PoolsToWarmUp, [this](const APoolHolder* A, const APoolHolder* B) {
+		return PoolEntries[A->GetPoolIndex()].WarmUpPriority > PoolEntries[B->GetPoolIndex()].WarmUpPriority;
+	});
+}
+
+void APoolManager::RetireSlotGenerations(APoolHolder* PoolHolder) {
+	PoolHolder->StoreSlotGenerations(RetiredSlotGenerations.FindOrAdd(PoolHolder->GetPoolIndex()));
+}
+
+APoolHolder* APoolManager::GetPoolOfObject(UObject* Object) {
+	for (auto& PoolHolder : PoolsToDrain) {
+		if (IsValid(PoolHolder) && PoolHolder->ContainsObject(Object)) return PoolHolder;
+	}
+
+	APoolHolder** PoolHolder = ClassesToPools.Find(Object->GetClass());
+	return PoolHolder != nullptr && IsValid(*PoolHolder) ? *PoolHolder : nullptr;
+}
+
+void APoolManager::SetDataTable(UDataTable* NewDataTable) {
+	if (NewDataTable == DataTable) return;
+
+	UnbindDataTable();
+	DataTable = NewDataTable;
+	BindDataTable();
+
+	// Before BeginPlay the pools are initialized with the new table anyway
+	if (HasActorBegunPlay()) {
+		InitializePools();
+	}
+}
+
+void APoolManager::BindDataTable() {
+#if WITH_EDITOR
+	// Rows which are edited while playing in the editor are applied to the pools
+	if (DataTable != nullptr && !DataTableChangedHandle.IsValid()) {
+		DataTableChangedHandle = DataTable->OnDataTableChanged().AddUObject(this, &APoolManager::OnDataTableChanged);
+	}
+#endif
+}
+
+void APoolManager::UnbindDataTable() {
+#if WITH_EDITOR
+	if (DataTable != nullptr && DataTableChangedHandle.IsValid()) {
+		DataTable->OnDataTableChanged().Remove(DataTableChangedHandle);
+	}
+	DataTableChangedHandle.Reset();
+#endif
+}
+
+void APoolManager::OnDataTableChanged() {
+	// The editor changes the table row by row, all changes of a frame are applied at once
+	bIsDataTableDirty = true;
+}
+
+void APoolManager::WarmUpPools() {
+	const double EndTime = FPlatformTime::Seconds() + WarmUpBudgetMs / 1000.0;
+
+	while (PoolsToWarmUp.Num() > 0) {
+		APoolHolder* PoolHolder = PoolsToWarmUp[0];
+		if (IsValid(PoolHolder)) {
+			if (!PoolHolder->WarmUp(EndTime, GetRemainingMemoryBytes())) break;
+			OnPoolReady.Broadcast(PoolHolder->GetPoolClass());
+		}
+		PoolsToWarmUp.RemoveAt(0, 1, false);
+	}
+
+	int32 NumberOfObjects = 0;
+	int32 DesiredNumberOfObjects = 0;
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder)) {
+			NumberOfObjects += FMath::Min(PoolHolder->GetNumberOfObjects(), PoolHolder->GetDesiredNumberOfObjects());
+			DesiredNumberOfObjects += PoolHolder->GetDesiredNumberOfObjects();
+		}
+	}
+	OnWarmUpProgress.Broadcast(DesiredNumberOfObjects > 0 ? (float)NumberOfObjects / DesiredNumberOfObjects : 1.f);
+
+	if (PoolsToWarmUp.Num() == 0) {
+		// Pools of soft classes which are loaded later on only report OnPoolReady
+		if (!bIsInitialized) {
+			bIsInitialized = true;
+			OnInitialized.Broadcast();
+		}
+	}
+}
+
+void APoolManager::CreatePool(int32 PoolIndex) {
+	const FPoolEntry& PoolEntry = PoolEntries[PoolIndex];
+	if (PoolEntry.UsesSoftClass()) {
+		// Soft classes which are already loaded don't have to wait
+		UClass* LoadedClass = PoolEntry.SoftClass.Get();
+		if (LoadedClass != nullptr) {
+			PoolsToWarmUp.Add(InitializeObjectPool(PoolIndex, LoadedClass));
+		}
+		else {
+			PendingPools.Add(PoolEntry.SoftClass.ToSoftObjectPath(), PoolIndex);
+			if (!PoolEntry.bLoadOnFirstAcquire) {
+				LoadPoolClass(PoolIndex);
+			}
+		}
+	}
+	else if (PoolEntry.Class) {
+		PoolsToWarmUp.Add(InitializeObjectPool(PoolIndex, PoolEntry.Class));
+	}
+}
+
+void APoolManager::AddStreamingLevelPool(int32 PoolIndex) {
+	FString PackageName = PoolEntries[PoolIndex].StreamingLevel.GetLongPackageName();
+#if WITH_EDITOR
+	// The streaming levels of a play in editor world are renamed, compare against the renamed packages
+	if (GetWorld()->WorldType == EWorldType::PIE) {
+		PackageName = UWorld::ConvertToPIEPackageName(PackageName, GetOutermost()->PIEInstanceID);
+	}
+#endif
+	const FName PackageFName(*PackageName);
+
+	FStreamingLevelPools* LevelPools = StreamingLevelPools.FindByPredicate([&PackageFName](const FStreamingLevelPools& Other) {
+		return Other.PackageName == PackageFName;
+	});
+	if (LevelPools == nullptr) {
+		LevelPools = &StreamingLevelPools[StreamingLevelPools.AddDefaulted()];
+		LevelPools->PackageName = PackageFName;
+	}
+	LevelPools->PoolIndices.Add(PoolIndex);
+
+	// Pools which are added at runtime for a loaded level are created right away
+	if (LevelPools->bIsLoaded) {
+		CreatePool(PoolIndex);
+	}
+}
+
+void APoolManager::RemoveUnfinishedDeferredSpawns() {
+	for (auto It = DeferredSpawnTransforms.CreateIterator(); It; ++It) {
+		AActor* Actor = It.Key().Get();
+		APoolHolder** PoolHolder = Actor != nullptr ? ClassesToPools.Find(Actor->GetClass()) : nullptr;
+		if (PoolHolder == nullptr || !IsValid(*PoolHolder) || !(*PoolHolder)->IsActivationDeferred(Actor)) {
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void APoolManager::UpdateStreamingLevelPools() {
+	if (StreamingLevelPools.Num() == 0) return;
+
+	const TArray<ULevelStreaming*>& StreamingLevels = GetWorld()->GetStreamingLevels();
+	for (auto& LevelPools : StreamingLevelPools) {
+		// A level counts as loaded as soon as it has been requested, so its pools warm up while the level is still loading
+		bool bShouldBeLoaded = false;
+		for (auto& LevelStreaming : StreamingLevels) {
+			if (LevelStreaming != nullptr && LevelStreaming->GetWorldAssetPackageFName() == LevelPools.PackageName) {
+				bShouldBeLoaded = LevelStreaming->ShouldBeLoaded();
+				break;
+			}
+		}
+
+		if (bShouldBeLoaded && !LevelPools.bIsLoaded) {
+			LoadStreamingLevelPools(LevelPools);
+		}
+		else if (!bShouldBeLoaded && LevelPools.bIsLoaded) {
+			UnloadStreamingLevelPools(LevelPools);
+		}
+	}
+}
+
+void APoolManager::LoadStreamingLevelPools(FStreamingLevelPools& LevelPools) {
+	LevelPools.bIsLoaded = true;
+
+	for (int32 PoolIndex : LevelPools.PoolIndices) {
+		APoolHolder* PoolHolder = Pools[PoolIndex];
+		if (IsValid(PoolHolder)) {
+			// The level has been loaded again before its pool was drained completely, fill it up again
+			PoolsToDrain.Remove(PoolHolder);
+			if (!PoolsToWarmUp.Contains(PoolHolder)) {
+				PoolHolder->ResetWarmUp();
+				PoolsToWarmUp.Add(PoolHolder);
+			}
+		}
+		else if (!PendingPools.Contains(PoolEntries[PoolIndex].SoftClass.ToSoftObjectPath())) {
+			CreatePool(PoolIndex);
+		}
+	}
+}
+
+void APoolManager::UnloadStreamingLevelPools(FStreamingLevelPools& LevelPools) {
+	LevelPools.bIsLoaded = false;
+
+	for (int32 PoolIndex : LevelPools.PoolIndices) {
+		APoolHolder* PoolHolder = Pools[PoolIndex];
+		if (IsValid(PoolHolder)) {
+			PoolsToWarmUp.Remove(PoolHolder);
+			PoolsToDrain.AddUnique(PoolHolder);
+		}
+		else if (PoolEntries[PoolIndex].UsesSoftClass()) {
+			// The class of the pool is still loading, the pool isn't needed anymore
+			PendingPools.Remove(PoolEntries[PoolIndex].SoftClass.ToSoftObjectPath());
+
+			TSharedPtr<FStreamableHandle>& StreamingHandle = PoolStreamingHandles[PoolIndex];
+			if (StreamingHandle.IsValid()) {
+				if (StreamingHandle->IsLoadingInProgress()) {
+					StreamingHandle->CancelHandle();
+				}
+				else {
+					StreamingHandle->ReleaseHandle();
+				}
+				StreamingHandle.Reset();
+			}
+		}
+	}
+}
+
+void APoolManager::DrainPools() {
+	const double EndTime = FPlatformTime::Seconds() + DrainBudgetMs / 1000.0;
+
+	int32 DrainIndex = 0;
+	while (DrainIndex < PoolsToDrain.Num()) {
+		APoolHolder* PoolHolder = PoolsToDrain[DrainIndex];
+		if (!IsValid(PoolHolder)) {
+			PoolsToDrain.RemoveAt(DrainIndex, 1, false);
+			continue;
+		}
+
+		PoolHolder->DestroyUnused(PoolHolder->GetNumberOfAvailableObjects(), EndTime);
+		if (PoolHolder->GetNumberOfAvailableObjects() > 0) break;
+
+		// The used objects are spawned in the persistent level and are still part of the gameplay.
+		// The pool keeps draining until they have been returned, destroying it now would destroy them as well
+		if (PoolHolder->HasObjectsInUse()) {
+			DrainIndex++;
+		}
+		else {
+			// A removed pool might have been replaced by a new pool of the same class at the same index
+			APoolHolder** ClassPoolHolder = ClassesToPools.Find(PoolHolder->GetPoolClass());
+			if (ClassPoolHolder != nullptr && *ClassPoolHolder == PoolHolder) {
+				ClassesToPools.Remove(PoolHolder->GetPoolClass());
+			}
+			if (Pools[PoolHolder->GetPoolIndex()] == PoolHolder) {
+				ReleasePool(PoolHolder->GetPoolIndex());
+			}
+			PoolHolder->Destroy();
+			PoolsToDrain.RemoveAt(DrainIndex, 1, false);
+		}
+
+		if (FPlatformTime::Seconds() >= EndTime) break;
+	}
+}
+
+void APoolManager::LoadPoolClass(int32 PoolIndex) {
+	// The class is still loaded, e.g. because the emptied pool has kept its assets
+	UClass* LoadedClass = PoolEntries[PoolIndex].SoftClass.Get();
+	if (LoadedClass != nullptr) {
+		if (Pools[PoolIndex] == nullptr) {
+			InitializePendingPool(PoolIndex, LoadedClass);
+		}
+		return;
+	}
+
+	if (PoolStreamingHandles[PoolIndex].IsValid() && PoolStreamingHandles[PoolIndex]->IsLoadingInProgress()) return;
+
+	const FSoftObjectPath& ClassPath = PoolEntries[PoolIndex].SoftClass.ToSoftObjectPath();
+	PoolStreamingHandles[PoolIndex] = StreamableManager.RequestAsyncLoad(ClassPath, FStreamableDelegate::CreateUObject(this, &APoolManager::OnPoolClassLoaded, PoolIndex, PoolGeneration));
+}
+
+void APoolManager::OnPoolClassLoaded(int32 PoolIndex, int32 Generation) {
+	// The pools have been rebuilt in the meantime or the pool has been created on demand
+	if (Generation != PoolGeneration) return;
+	if (!PoolEntries.IsValidIndex(PoolIndex) || Pools[PoolIndex] != nullptr || !PoolEntries[PoolIndex].UsesSoftClass()) return;
+
+	UClass* LoadedClass = PoolEntries[PoolIndex].SoftClass.Get();
+	if (LoadedClass == nullptr) {
+		UE_LOG(LogTemp, Error, TEXT("Failed to load the pool class %s!"), *PoolEntries[PoolIndex].SoftClass.ToString());
+		return;
+	}
+
+	InitializePendingPool(PoolIndex, LoadedClass);
+}
+
+APoolHolder* APoolManager::ResolvePendingPool(int32 PoolIndex) {
+	if (!PoolEntries.IsValidIndex(PoolIndex) || !PoolEntries[PoolIndex].UsesSoftClass()) return nullptr;
+
+	const int32* PendingPoolIndex = PendingPools.Find(PoolEntries[PoolIndex].SoftClass.ToSoftObjectPath());
+	if (PendingPoolIndex == nullptr || *PendingPoolIndex != PoolIndex) return nullptr;
+
+	LoadPoolClass(PoolIndex);
+	return Pools[PoolIndex];
+}
+
+APoolHolder* APoolManager::InitializePendingPool(int32 PoolIndex, UClass* Class) {
+	PendingPools.Remove(PoolEntries[PoolIndex].SoftClass.ToSoftObjectPath());
+
+	APoolHolder* PoolHolder = InitializeObjectPool(PoolIndex, Class);
+	if (bTimeSlicedWarmUp || PoolEntries[PoolIndex].IsLevelScoped()) {
+		PoolsToWarmUp.Add(PoolHolder);
+	}
+	else {
+		PoolHolder->WarmUp(TNumericLimits<double>::Max(), GetRemainingMemoryBytes());
+		OnPoolReady.Broadcast(Class);
+	}
+
+	return PoolHolder;
+}
+
+void APoolManager::ReleasePool(int32 PoolIndex) {
+	if (IsValid(Pools[PoolIndex])) {
+		RetireSlotGenerations(Pools[PoolIndex]);
+	}
+	Pools[PoolIndex] = nullptr;
+
+	const FPoolEntry& PoolEntry = PoolEntries[PoolIndex];
+	if (PoolEntry.UsesSoftClass()) {
+		// The pools of streaming levels always release their assets, they are loaded again with the level
+		if ((PoolEntry.bReleaseAssetsOnEmpty || PoolEntry.IsLevelScoped()) && PoolStreamingHandles[PoolIndex].IsValid()) {
+			PoolStreamingHandles[PoolIndex]->ReleaseHandle();
+			PoolStreamingHandles[PoolIndex].Reset();
+		}
+
+		// The pool will be created again on the next request
+		if (!PoolEntry.IsLevelScoped()) {
+			PendingPools.Add(PoolEntry.SoftClass.ToSoftObjectPath(), PoolIndex);
+		}
+	}
+}
+
+void APoolManager::RequestPoolLoad(const UObject* WorldContextObject, TSoftClassPtr<UObject> Class) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	if (PoolManager == nullptr) return;
+
+	const int32* PoolIndex = PoolManager->PendingPools.Find(Class.ToSoftObjectPath());
+	if (PoolIndex != nullptr) {
+		PoolManager->LoadPoolClass(*PoolIndex);
+	}
+}
+
+void APoolManager::UpdatePoolSizes(float DeltaSeconds) {
+	const double EndTime = FPlatformTime::Seconds() + SizingBudgetMs / 1000.0;
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder) && PoolHolder->UsesAdaptiveSize() && !PoolsToDrain.Contains(PoolHolder)) {
+			PoolHolder->UpdateSize(DeltaSeconds, EndTime);
+		}
+	}
+}
+
+int64 APoolManager::GetRemainingMemoryBytes() const {
+	if (MemoryBudgetMB <= 0) return TNumericLimits<int64>::Max();
+
+	int64 MemoryBytes = 0;
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder)) {
+			MemoryBytes += PoolHolder->GetMemoryBytes();
+		}
+	}
+	return (int64)MemoryBudgetMB * 1024 * 1024 - MemoryBytes;
+}
+
+void APoolManager::TrimPools() {
+	const double EndTime = FPlatformTime::Seconds() + TrimBudgetMs / 1000.0;
+
+	int64 MemoryBytes = 0;
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder)) {
+			PoolHolder->ShrinkToDesiredSize(EndTime);
+			PoolHolder->TrimToMemoryBudget(EndTime);
+			MemoryBytes += PoolHolder->GetMemoryBytes();
+		}
+	}
+	PoolManagerStats::MemoryBytes += MemoryBytes;
+	SET_DWORD_STAT(STAT_PoolMemory, PoolManagerStats::MemoryBytes / 1024);
+
+	const int64 MemoryBudgetBytes = (int64)MemoryBudgetMB * 1024 * 1024;
+	const bool bIsOverBudget = MemoryBudgetBytes > 0 && MemoryBytes > MemoryBudgetBytes;
+	if (bIsOverBudget != bIsOverMemoryBudget) {
+		bIsOverMemoryBudget = bIsOverBudget;
+		for (auto& PoolHolder : Pools) {
+			if (IsValid(PoolHolder)) {
+				PoolHolder->SetGrowthAllowed(!bIsOverBudget);
+			}
+		}
+	}
+	if (!bIsOverBudget || FPlatformTime::Seconds() >= EndTime) return;
+
+	// Trim the pools with the lowest warm up priority first
+	TArray<APoolHolder*, TInlineAllocator<16>> PoolsToTrim;
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder) && PoolHolder->GetNumberOfAvailableObjects() > 0 && PoolHolder->GetBytesPerObject() > 0) {
+			PoolsToTrim.Add(PoolHolder);
+		}
+	}
+	Algo::StableSort(PoolsToTrim, [this](const APoolHolder* A, const APoolHolder* B) {
+		return PoolEntries[A->GetPoolIndex()].WarmUpPriority < PoolEntries[B->GetPoolIndex()].WarmUpPriority;
+	});
+
+	int64 ExcessBytes = MemoryBytes - MemoryBudgetBytes;
+	for (auto& PoolHolder : PoolsToTrim) {
+		const int64 BytesPerObject = PoolHolder->GetBytesPerObject();
+		ExcessBytes -= PoolHolder->DestroyUnused((int32)FMath::DivideAndRoundUp(ExcessBytes, BytesPerObject), EndTime) * BytesPerObject;
+		if (ExcessBytes <= 0 || FPlatformTime::Seconds() >= EndTime) break;
+	}
+}
+
+void APoolManager::ReturnToPoolDeferred(UObject* Object) {
+	if (Object != nullptr) {
+		DeferredReturns.Enqueue(Object);
+	}
+}
+
+void APoolManager::ReturnExpiredObjects() {
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+	for (auto& PoolHolder : Pools) {
+		if (IsValid(PoolHolder) && PoolHolder->GetLifeSpan() > 0) {
+			PoolHolder->ReturnExpiredObjects(WorldTime);
+		}
+	}
+
+	// The removed pools aren't a part of the pools anymore, their expired objects let them finish draining
+	for (auto& PoolHolder : PoolsToDrain) {
+		if (IsValid(PoolHolder) && PoolHolder->GetLifeSpan() > 0 && Pools[PoolHolder->GetPoolIndex()] != PoolHolder) {
+			PoolHolder->ReturnExpiredObjects(WorldTime);
+		}
+	}
+}
+
+void APoolManager::ProcessDeferredReturns() {
+	if (DeferredReturns.IsEmpty()) return;
+
+	// The queue is shared by all worlds, every object goes to the pool of its own world
+	TWeakObjectPtr<UObject> WeakObject;
+	while (DeferredReturns.Dequeue(WeakObject)) {
+		UObject* Object = WeakObject.Get();
+		if (!IsValid(Object)) continue;
+
+		APoolManager* PoolManager = GetPoolManager(Object);
+		APoolHolder* PoolHolder = PoolManager != nullptr ? PoolManager->GetPoolOfObject(Object) : nullptr;
+		if (PoolHolder != nullptr) {
+			DeferredReturnBatch.Emplace(PoolHolder, Object);
+		}
+	}
+
+	// Group the objects by their pool, every pool deactivates its objects in one batch
+	DeferredReturnBatch.Sort([](const TPair<APoolHolder*, UObject*>& A, const TPair<APoolHolder*, UObject*>& B) {
+		return A.Key < B.Key;
+	});
+
+	int32 BatchStart = 0;
+	while (BatchStart < DeferredReturnBatch.Num()) {
+		APoolHolder* PoolHolder = DeferredReturnBatch[BatchStart].Key;
+		int32 BatchEnd = BatchStart;
+		while (BatchEnd < DeferredReturnBatch.Num() && DeferredReturnBatch[BatchEnd].Key == PoolHolder) {
+			DeferredReturnGroup.Add(DeferredReturnBatch[BatchEnd].Value);
+			BatchEnd++;
+		}
+
+		PoolHolder->ReturnObjects(DeferredReturnGroup);
+		DeferredReturnGroup.Reset();
+		BatchStart = BatchEnd;
+	}
+
+	DeferredReturnBatch.Reset();
 }
 
 void APoolManager::ReturnToPool(UObject* Object) {
-	APoolHolder* PoolHolder;
-	if (!Instance->GetPoolHolder(Object->GetClass(), PoolHolder)) return;
+	if (!IsValid(Object)) return;
+	APoolManager* PoolManager = GetPoolManager(Object);
+	if (PoolManager == nullptr) return;
+
+	// The objects of a removed pool go back to it, even if a new pool of their class exists
+	APoolHolder* PoolHolder = PoolManager->GetPoolOfObject(Object);
+	if (PoolHolder == nullptr && !PoolManager->GetPoolHolder(Object->GetClass(), PoolHolder)) return;
 	if (!IsValid(PoolHolder)) return;
 	PoolHolder->ReturnObject(Object);
 }
 
-void APoolManager::EmptyObjectPool(TSubclassOf<UObject> Class) {
+void APoolManager::EmptyObjectPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class) {
 	if (Class) {
-		if (!IsValid(Instance)) return;
-		if (Instance->ClassNamesToPools.Num() == 0) return;
-		Instance->bIsReady = false;
+		APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+		if (PoolManager == nullptr) return;
+		if (PoolManager->ClassesToPools.Num() == 0) return;
+		PoolManager->bIsReady = false;
 
-		APoolHolder* PoolHolder = *Instance->ClassNamesToPools.Find(*Class->GetName());
-		if (!IsValid(PoolHolder)) return;
+		APoolHolder* PoolHolder = nullptr;
+		if (!PoolManager->ClassesToPools.RemoveAndCopyValue(Class, PoolHolder) || !IsValid(PoolHolder)) {
+			PoolManager->bIsReady = true;
+			return;
+		}
+
+		// Keep the slot of the pool to not invalidate the other pool handles
+		const int32 PoolIndex = PoolManager->Pools.Find(PoolHolder);
+		if (PoolIndex != INDEX_NONE) {
+			PoolManager->ReleasePool(PoolIndex);
+		}
 
 		PoolHolder->Destroy();
-		Instance->ClassNamesToPools.Remove(*Class->GetName());
-		Instance->bIsReady = true;
+		PoolManager->bIsReady = true;
+	}
+}
+
+FPoolHandle APoolManager::AddObjectPool(const FPoolEntry& PoolEntry) {
+	UClass* Class = PoolEntry.UsesSoftClass() ? PoolEntry.SoftClass.Get() : PoolEntry.Class;
+
+	APoolHolder** ExistingPoolHolder = Class != nullptr ? ClassesToPools.Find(Class) : nullptr;
+	if (ExistingPoolHolder != nullptr) {
+		return FPoolHandle(this, Pools.Find(*ExistingPoolHolder), PoolGeneration);
+	}
+
+	const int32 PoolIndex = AddPoolEntry(PoolEntry);
+	if (PoolEntry.IsLevelScoped()) {
+		AddStreamingLevelPool(PoolIndex);
+	}
+	else if (Class != nullptr) {
+		APoolHolder* PoolHolder = InitializeObjectPool(PoolIndex, Class);
+		PoolHolder->WarmUp(TNumericLimits<double>::Max(), GetRemainingMemoryBytes());
+		OnPoolReady.Broadcast(Class);
+	}
+	else if (PoolEntry.UsesSoftClass()) {
+		PendingPools.Add(PoolEntry.SoftClass.ToSoftObjectPath(), PoolIndex);
+		if (!PoolEntry.bLoadOnFirstAcquire) {
+			LoadPoolClass(PoolIndex);
+		}
 	}
+
+	return FPoolHandle(this, PoolIndex, PoolGeneration);
+}
+
+int32 APoolManager::AddPoolEntry(const FPoolEntry& PoolEntry) {
+	PoolEntries.Add(PoolEntry);
+	PoolStreamingHandles.AddDefaulted();
+	DataTablePools.Add(false);
+	return Pools.Add(nullptr);
 }
 
-void APoolManager::InitializeObjectPool(FPoolEntry PoolEntry) {
+APoolHolder* APoolManager::InitializeObjectPool(int32 PoolIndex, UClass* Class) {
 	APoolHolder* PoolHolder = GetWorld()->SpawnActor<APoolHolder>(APoolHolder::StaticClass(), GetTransform());
 	PoolHolder->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
 
-	PoolHolder->InitializePool(PoolEntry);
-	ClassNamesToPools.Add(PoolEntry.Class->GetName(), PoolHolder);
+	FPoolEntry PoolEntry = PoolEntries[PoolIndex];
+	PoolEntry.Class = Class;
+	PoolHolder->SetPoolIndex(PoolIndex);
+	if (const TArray<uint8>* SlotGenerations = RetiredSlotGenerations.Find(PoolIndex)) {
+		PoolHolder->ContinueSlotGenerations(*SlotGenerations);
+	}
+	PoolHolder->SetGrowthAllowed(!bIsOverMemoryBudget);
+	PoolHolder->BeginInitializePool(PoolEntry);
+	ClassesToPools.Add(Class, PoolHolder);
+	Pools[PoolIndex] = PoolHolder;
+
+	return PoolHolder;
 }
 
 FString APoolManager::GetObjectName(UObject* Object) {
@@ -272,49 +1321,173 @@ FString APoolManager::GetObjectName(UObject* Object) {
 	return Name;
 }
 
-int32 APoolManager::GetNumberOfUsedObjects(TSubclassOf<UObject> Class) {
+FPoolObjectId APoolManager::GetObjectId(UObject* Object) {
+	if (!IsValid(Object)) return FPoolObjectId();
+	APoolManager* PoolManager = GetPoolManager(Object);
+	if (PoolManager == nullptr) return FPoolObjectId();
+
+	APoolHolder** PoolHolder = PoolManager->ClassesToPools.Find(Object->GetClass());
+	if (PoolHolder == nullptr || !IsValid(*PoolHolder)) return FPoolObjectId();
+
+	(*PoolHolder)->CheckStableIds(PoolManager->MemoryBudgetMB > 0);
+	return (*PoolHolder)->GetObjectId(Object);
+}
+
+UObject* APoolManager::GetObjectById(const UObject* WorldContextObject, FPoolObjectId ObjectId) {
+	if (!ObjectId.IsValid()) return nullptr;
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	if (PoolManager == nullptr) return nullptr;
+
+	const int32 PoolIndex = ObjectId.GetPoolIndex();
+	APoolHolder* PoolHolder = PoolManager->Pools.IsValidIndex(PoolIndex) ? PoolManager->Pools[PoolIndex] : nullptr;
+	if (!IsValid(PoolHolder)) return nullptr;
+
+	return PoolHolder->GetObjectById(ObjectId);
+}
+
+UObject* APoolManager::GetSpecificFromPool(const UObject* WorldContextObject, FPoolObjectId ObjectId, FSpawnParameter SpawnParameter, EHandleNoSpecificFound HandleNoSpecificFound) {
+	if (!ObjectId.IsValid()) return nullptr;
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	if (PoolManager == nullptr) return nullptr;
+
+	const int32 PoolIndex = ObjectId.GetPoolIndex();
+	APoolHolder* PoolHolder = PoolManager->Pools.IsValidIndex(PoolIndex) ? PoolManager->Pools[PoolIndex] : nullptr;
+	if (!IsValid(PoolHolder)) {
+		UE_LOG(LogTemp, Warning, TEXT("The pool %d of the object id doesn't exist!"), PoolIndex);
+		return nullptr;
+	}
+
+	FSpecificSearch SpecificSearch;
+	SpecificSearch.SpecificId = ObjectId;
+	SpecificSearch.HandleNoSpecificFound = HandleNoSpecificFound;
+	return AcquireFromPoolHolder(PoolHolder, SpawnParameter, &SpecificSearch);
+}
+
+FPoolInstanceHandle APoolManager::SpawnInstanceFromPool(const UObject* WorldContextObject, TSubclassOf<AActor> Class, FTransform Transform) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	APoolHolder* PoolHolder;
+	if (!Class || PoolManager == nullptr || !PoolManager->GetPoolHolder(Class, PoolHolder) || !IsValid(PoolHolder)) return FPoolInstanceHandle();
+
+	if (!PoolHolder->UsesInstances()) {
+		UE_LOG(LogTemp, Error, TEXT("The pool of %s doesn't have an instanced mesh!"), *Class->GetName());
+		return FPoolInstanceHandle();
+	}
+
+	return PoolHolder->AddInstance(Transform);
+}
+
+bool APoolManager::ReturnInstanceToPool(const UObject* WorldContextObject, FPoolInstanceHandle Handle) {
+	APoolHolder* PoolHolder = GetInstancePool(WorldContextObject, Handle);
+	return PoolHolder != nullptr && PoolHolder->RemoveInstance(Handle);
+}
+
+bool APoolManager::SetInstanceTransform(const UObject* WorldContextObject, FPoolInstanceHandle Handle, FTransform Transform) {
+	APoolHolder* PoolHolder = GetInstancePool(WorldContextObject, Handle);
+	return PoolHolder != nullptr && PoolHolder->GetMutableInstances().SetTransform(Handle, Transform);
+}
+
+bool APoolManager::GetInstanceTransform(const UObject* WorldContextObject, FPoolInstanceHandle Handle, FTransform& Transform) {
+	APoolHolder* PoolHolder = GetInstancePool(WorldContextObject, Handle);
+	return PoolHolder != nullptr && PoolHolder->GetInstances().GetTransform(Handle, Transform);
+}
+
+AActor* APoolManager::PromoteInstance(const UObject* WorldContextObject, FPoolInstanceHandle Handle, FSpawnParameter SpawnParameter) {
+	APoolHolder* PoolHolder = GetInstancePool(WorldContextObject, Handle);
+	if (PoolHolder == nullptr) return nullptr;
+
+	AActor* PromotedActor = PoolHolder->GetPromotedActor(Handle);
+	if (PromotedActor != nullptr) return PromotedActor;
+	if (PoolHolder->GetInstances().GetState(Handle) != FPoolInstanceSet::EState::Active) return nullptr;
+
+	// The actor is moved to the instance before it gets activated. It has to be a part of the pool to be demoted again
+	const bool bSetActive = SpawnParameter.bSetActive;
+	SpawnParameter.bSetActive = false;
+	if (SpawnParameter.HandleEmptyPool == EHandleEmptyPool::CREATE) {
+		SpawnParameter.HandleEmptyPool = EHandleEmptyPool::CREATE_AND_ADD;
+	}
+
+	AActor* Actor = Cast<AActor>(AcquireFromPoolHolder(PoolHolder, SpawnParameter));
+	if (Actor == nullptr) return nullptr;
+
+	if (!PoolHolder->PromoteInstance(Handle, Actor)) {
+		PoolHolder->ReturnObject(Actor);
+		return nullptr;
+	}
+
+	if (bSetActive) {
+		PoolHolder->SetObjectActive(Actor);
+	}
+	return Actor;
+}
+
+FPoolInstanceHandle APoolManager::DemoteToInstance(AActor* Actor) {
+	if (!IsValid(Actor)) return FPoolInstanceHandle();
+	APoolManager* PoolManager = GetPoolManager(Actor);
+	if (PoolManager == nullptr) return FPoolInstanceHandle();
+
+	APoolHolder** PoolHolder = PoolManager->ClassesToPools.Find(Actor->GetClass());
+	if (PoolHolder == nullptr || !IsValid(*PoolHolder) || !(*PoolHolder)->UsesInstances()) {
+		UE_LOG(LogTemp, Error, TEXT("The actor %s doesn't belong to a pool with an instanced mesh!"), *Actor->GetName());
+		return FPoolInstanceHandle();
+	}
+
+	return (*PoolHolder)->DemoteActor(Actor);
+}
+
+AActor* APoolManager::GetPromotedActor(const UObject* WorldContextObject, FPoolInstanceHandle Handle) {
+	APoolHolder* PoolHolder = GetInstancePool(WorldContextObject, Handle);
+	return PoolHolder != nullptr ? PoolHolder->GetPromotedActor(Handle) : nullptr;
+}
+
+FVector4* APoolManager::GetInstancePayload(const UObject* WorldContextObject, FPoolInstanceHandle Handle) {
+	APoolHolder* PoolHolder = GetInstancePool(WorldContextObject, Handle);
+	return PoolHolder != nullptr ? PoolHolder->GetMutableInstances().GetPayload(Handle) : nullptr;
+}
+
+APoolHolder* APoolManager::GetInstancePool(const UObject* WorldContextObject, FPoolInstanceHandle Handle) {
+	if (!Handle.IsValid()) return nullptr;
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	if (PoolManager == nullptr) return nullptr;
+
+	APoolHolder* PoolHolder = PoolManager->Pools.IsValidIndex(Handle.PoolIndex) ? PoolManager->Pools[Handle.PoolIndex] : nullptr;
+	return IsValid(PoolHolder) && PoolHolder->UsesInstances() ? PoolHolder : nullptr;
+}
+
+int32 APoolManager::GetNumberOfUsedObjects(const UObject* WorldContextObject, TSubclassOf<UObject> Class) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
 	APoolHolder* PoolHolder;
-	if (!Instance->GetPoolHolder(Class, PoolHolder)) return -1;
+	if (PoolManager == nullptr || !PoolManager->GetPoolHolder(Class, PoolHolder)) return -1;
 	if (!IsValid(PoolHolder)) return -1;
 
 	return PoolHolder->GetNumberOfUsedObjects();
 }
 
-int32 APoolManager::GetNumberOfAvailableObjects(TSubclassOf<UObject> Class) {
+int32 APoolManager::GetNumberOfAvailableObjects(const UObject* WorldContextObject, TSubclassOf<UObject> Class) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
 	APoolHolder* PoolHolder;
-	if (!Instance->GetPoolHolder(Class, PoolHolder)) return -1;
+	if (PoolManager == nullptr || !PoolManager->GetPoolHolder(Class, PoolHolder)) return -1;
 	if (!IsValid(PoolHolder)) return -1;
 
 	return PoolHolder->GetNumberOfAvailableObjects();
 }
 
 bool APoolManager::IsObjectActive(UObject* Object) {
-	AActor* Actor = Cast<AActor>(Object);
-	if (Actor->IsValidLowLevel()) {
-		AActor* AttachedTo = Actor->GetAttachParentActor();
-		if (AttachedTo->IsValidLowLevel()) {
-			return !AttachedTo->GetClass()->IsChildOf(APoolHolder::StaticClass());
-		}
-		else {
-			return true;
-		}
-	}
-	else {
-		APoolHolder* PoolHolder;
-		if (Instance->GetPoolHolder(Object->GetClass(), PoolHolder)) {
-			if (PoolHolder->IsValidLowLevel()) {
-				return !PoolHolder->IsObjectAvailable(Object);
-			}
-		}
+	if (!IsValid(Object)) return false;
+
+	// Objects which are not a part of any pool are always active
+	APoolManager* PoolManager = GetPoolManager(Object);
+	APoolHolder* PoolHolder = PoolManager != nullptr ? PoolManager->GetPoolOfObject(Object) : nullptr;
+	if (PoolHolder != nullptr) {
+		return !PoolHolder->IsObjectAvailable(Object);
 	}
 
-	return false;
+	return true;
 }
 
-bool APoolManager::ContainsClass(TSubclassOf<UObject> Class) {
-	if (!Class) return false;
-	FString Key = Class->GetName();
-	return Instance->ClassNamesToPools.Contains(Key);
+bool APoolManager::ContainsClass(const UObject* WorldContextObject, TSubclassOf<UObject> Class) {
+	APoolManager* PoolManager = GetPoolManager(WorldContextObject);
+	if (!Class || PoolManager == nullptr) return false;
+	return PoolManager->ClassesToPools.Contains(Class);
 }
 
 void APoolManager::DestroyAllPools() {
@@ -326,25 +1499,42 @@ void APoolManager::DestroyAllPools() {
 		Actor->Destroy();
 	}
 
-	TArray<APoolHolder*> Pools;
-	ClassNamesToPools.GenerateValueArray(Pools);
 	for (auto& PoolHolder : Pools) {
-		if (!PoolHolder->IsPendingKill()) {
+		if (IsValid(PoolHolder)) {
 			PoolHolder->Destroy();
 		}
 	}
-}
 
-bool APoolManager::IsPoolManagerReady() {
-	if (Instance == nullptr) return false;
-	if (!Instance->IsValidLowLevel()) return false;
-	if (Instance->ClassNamesToPools.Num() == 0) return false;
-	if (!Instance->bIsReady) return false;
+	for (auto& StreamingHandle : PoolStreamingHandles) {
+		if (StreamingHandle.IsValid()) {
+			StreamingHandle->ReleaseHandle();
+		}
+	}
 
-	return true;
+	ClassesToPools.Empty();
+	Pools.Empty();
+	PoolEntries.Empty();
+	PoolStreamingHandles.Empty();
+	DataTablePools.Empty();
+	PendingPools.Empty();
+	PoolsToDrain.Empty();
+	RetiredSlotGenerations.Empty();
+	StreamingLevelPools.Empty();
+	DeferredSpawnTransforms.Empty();
+	PoolGeneration++;
+}
+
+bool APoolManager::IsPoolManagerReady() const {
+	return bIsReady;
 }
 
 void APoolManager::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	UnbindDataTable();
 	DestroyAllPools();
+
+	APoolManager** PoolManager = WorldsToPoolManagers.Find(GetWorld());
+	if (PoolManager != nullptr && *PoolManager == this) {
+		WorldsToPoolManagers.Remove(GetWorld());
+	}
 	Super::EndPlay(EndPlayReason);
 }
\ No newline at end of file
@@ -0,0 +1,203 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "PoolSnapshot.h"
+#include "UObject/Package.h"
+
+namespace PoolSnapshot
+{
+	// Nested structs are only followed this deep, deeper properties are treated as unsupported
+	static constexpr int32 MaxDepth = 8;
+
+	// Returns true if the values of the property can contain object references
+	static bool ContainsObjectReferences(const UProperty* Property, int32 Depth = 0) {
+		if (Depth > MaxDepth) return true;
+		if (Property->IsA<UObjectPropertyBase>() || Property->IsA<UInterfaceProperty>()) return true;
+
+		if (const UArrayProperty* ArrayProperty = Cast<const UArrayProperty>(Property)) {
+			return ContainsObjectReferences(ArrayProperty->Inner, Depth + 1);
+		}
+		if (const USetProperty* SetProperty = Cast<const USetProperty>(Property)) {
+			return ContainsObjectReferences(SetProperty->ElementProp, Depth + 1);
+		}
+		if (const UMapProperty* MapProperty = Cast<const UMapProperty>(Property)) {
+			return ContainsObjectReferences(MapProperty->KeyProp, Depth + 1) || ContainsObjectReferences(MapProperty->ValueProp, Depth + 1);
+		}
+		if (const UStructProperty* StructProperty = Cast<const UStructProperty>(Property)) {
+			for (TFieldIterator<UProperty> It(StructProperty->Struct); It; ++It) {
+				if (ContainsObjectReferences(*It, Depth + 1)) return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Returns true if the values of the property can contain object references which ForEachObjectReference doesn't visit
+	static bool ContainsUnsupportedReferences(const UProperty* Property, int32 Depth = 0) {
+		if (Depth > MaxDepth || Property->IsA<UInterfaceProperty>()) return true;
+
+		if (const UArrayProperty* ArrayProperty = Cast<const UArrayProperty>(Property)) {
+			return ContainsUnsupportedReferences(ArrayProperty->Inner, Depth + 1);
+		}
+		if (const USetProperty* SetProperty = Cast<const USetProperty>(Property)) {
+			return ContainsObjectReferences(SetProperty->ElementProp, Depth + 1);
+		}
+		if (const UMapProperty* MapProperty = Cast<const UMapProperty>(Property)) {
+			return ContainsObjectReferences(MapProperty->KeyProp, Depth + 1) || ContainsObjectReferences(MapProperty->ValueProp, Depth + 1);
+		}
+		if (const UStructProperty* StructProperty = Cast<const UStructProperty>(Property)) {
+			for (TFieldIterator<UProperty> It(StructProperty->Struct); It; ++It) {
+				if (ContainsUnsupportedReferences(*It, Depth + 1)) return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Calls the function with every object reference inside the value, including the ones of arrays and nested structs
+	template<typename FunctionType>
+	static void ForEachObjectReference(const UProperty* Property, void* Value, const FunctionType& Function) {
+		for (int32 i = 0; i < Property->ArrayDim; i++) {
+			void* Element = (uint8*)Value + i * Property->ElementSize;
+
+			if (const UObjectPropertyBase* ObjectProperty = Cast<const UObjectPropertyBase>(Property)) {
+				Function(ObjectProperty, Element);
+			}
+			else if (const UArrayProperty* ArrayProperty = Cast<const UArrayProperty>(Property)) {
+				FScriptArrayHelper ArrayHelper(ArrayProperty, Element);
+				for (int32 j = 0; j < ArrayHelper.Num(); j++) {
+					ForEachObjectReference(ArrayProperty->Inner, ArrayHelper.GetRawPtr(j), Function);
+				}
+			}
+			else if (const UStructProperty* StructProperty = Cast<const UStructProperty>(Property)) {
+				for (TFieldIterator<UProperty> It(StructProperty->Struct); It; ++It) {
+					ForEachObjectReference(*It, It->ContainerPtrToValuePtr<void>(Element), Function);
+				}
+			}
+		}
+	}
+}
+
+
+FPoolPropertySnapshot::FPoolPropertySnapshot(const FPoolPropertySnapshot& Other) {
+	CopyFrom(Other);
+}
+
+FPoolPropertySnapshot& FPoolPropertySnapshot::operator=(const FPoolPropertySnapshot& Other) {
+	if (this != &Other) {
+		Reset();
+		CopyFrom(Other);
+	}
+	return *this;
+}
+
+FPoolPropertySnapshot::~FPoolPropertySnapshot() {
+	Reset();
+}
+
+bool FPoolPropertySnapshot::IsResetRelevant(const UProperty* Property) {
+	if (Property->HasAnyPropertyFlags(CPF_Deprecated | CPF_InstancedReference | CPF_ContainsInstancedReference)) return false;
+	if (Property->IsA<UMulticastDelegateProperty>() || Property->IsA<UDelegateProperty>()) return false;
+	// The object references have to be visited to report them to the garbage collector
+	if (PoolSnapshot::ContainsUnsupportedReferences(Property)) return false;
+
+	// The engine properties are restored by the pool holder itself
+	const UClass* OwnerClass = Property->GetOwnerClass();
+	if (OwnerClass == nullptr) return false;
+	const FName PackageName = OwnerClass->GetOutermost()->GetFName();
+	static const FName EnginePackageName(TEXT("/Script/Engine"));
+	static const FName CoreUObjectPackageName(TEXT("/Script/CoreUObject"));
+
+	return PackageName != EnginePackageName && PackageName != CoreUObjectPackageName;
+}
+
+void FPoolPropertySnapshot::Capture(const UObject* Object, const UObject* Owner) {
+	Reset();
+	if (Object == nullptr) return;
+
+	// Lay out all values first to allocate the blob only once
+	int32 Size = 0;
+	for (TFieldIterator<UProperty> It(Object->GetClass()); It; ++It) {
+		if (!IsResetRelevant(*It)) continue;
+
+		Size = Align(Size, It->GetMinAlignment());
+		Properties.Add({ *It, Size, PoolSnapshot::ContainsObjectReferences(*It) });
+		Size += It->GetSize();
+	}
+
+	Values.SetNumZeroed(Size);
+	for (auto& Captured : Properties) {
+		uint8* Value = Values.GetData() + Captured.Offset;
+		Captured.Property->InitializeValue(Value);
+		Captured.Property->CopyCompleteValue(Value, Captured.Property->ContainerPtrToValuePtr<void>(Object));
+
+		// A reference to the object itself or to one of its subobjects would point every pooled object to the captured one
+		if (Captured.bHasObjectReferences) {
+			const UObject* Outer = Owner != nullptr ? Owner : Object;
+			bool bReferencesSubobject = false;
+			PoolSnapshot::ForEachObjectReference(Captured.Property, Value, [Outer, &bReferencesSubobject](const UObjectPropertyBase* ObjectProperty, void* Element) {
+				const UObject* ReferencedObject = ObjectProperty->GetObjectPropertyValue(Element);
+				bReferencesSubobject |= ReferencedObject != nullptr && (ReferencedObject == Outer || ReferencedObject->IsIn(Outer));
+			});
+
+			if (bReferencesSubobject) {
+				Captured.Property->DestroyValue(Value);
+				Captured.Property = nullptr;
+			}
+		}
+	}
+
+	Properties.RemoveAll([](const FCapturedProperty& Captured) {
+		return Captured.Property == nullptr;
+	});
+}
+
+int32 FPoolPropertySnapshot::RestoreDirty(UObject* Object) const {
+	int32 NumberOfRestoredProperties = 0;
+	for (auto& Captured : Properties) {
+		const uint8* Value = Values.GetData() + Captured.Offset;
+		void* ObjectValue = Captured.Property->ContainerPtrToValuePtr<void>(Object);
+
+		// Identical only compares a single element of static arrays
+		const int32 ElementSize = Captured.Property->ElementSize;
+		for (int32 i = 0; i < Captured.Property->ArrayDim; i++) {
+			if (!Captured.Property->Identical((uint8*)ObjectValue + i * ElementSize, Value + i * ElementSize)) {
+				Captured.Property->CopyCompleteValue(ObjectValue, Value);
+				NumberOfRestoredProperties++;
+				break;
+			}
+		}
+	}
+
+	return NumberOfRestoredProperties;
+}
+
+void FPoolPropertySnapshot::Reset() {
+	for (auto& Captured : Properties) {
+		Captured.Property->DestroyValue(Values.GetData() + Captured.Offset);
+	}
+	Properties.Empty();
+	Values.Empty();
+}
+
+void FPoolPropertySnapshot::AddReferencedObjects(FReferenceCollector& Collector) {
+	for (auto& Captured : Properties) {
+		if (!Captured.bHasObjectReferences) continue;
+
+		PoolSnapshot::ForEachObjectReference(Captured.Property, Values.GetData() + Captured.Offset, [&Collector](const UObjectPropertyBase* ObjectProperty, void* Element) {
+			// Weak, lazy and soft references don't keep their objects alive
+			if (ObjectProperty->IsA<UObjectProperty>()) {
+				Collector.AddReferencedObject(*(UObject**)Element);
+			}
+		});
+	}
+}
+
+void FPoolPropertySnapshot::CopyFrom(const FPoolPropertySnapshot& Other) {
+	Properties = Other.Properties;
+	Values.SetNumZeroed(Other.Values.Num());
+	for (auto& Captured : Properties) {
+		uint8* Value = Values.GetData() + Captured.Offset;
+		Captured.Property->InitializeValue(Value);
+		Captured.Property->CopyCompleteValue(Value, Other.Values.GetData() + Captured.Offset);
+	}
+}
@@ -0,0 +1,23 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "PoolStats.h"
+
+DEFINE_STAT(STAT_PoolAcquire);
+DEFINE_STAT(STAT_PoolRelease);
+DEFINE_STAT(STAT_PoolRestore);
+DEFINE_STAT(STAT_PoolBatchedUpdate);
+DEFINE_STAT(STAT_PoolInstanceFlush);
+
+DEFINE_STAT(STAT_PoolAcquires);
+DEFINE_STAT(STAT_PoolReleases);
+DEFINE_STAT(STAT_PoolMisses);
+DEFINE_STAT(STAT_PoolOnDemandCreations);
+
+DEFINE_STAT(STAT_PoolObjectsInUse);
+DEFINE_STAT(STAT_PoolObjectsAvailable);
+DEFINE_STAT(STAT_PoolMemory);
+DEFINE_STAT(STAT_PoolInstancesActive);
+DEFINE_STAT(STAT_PoolInstancesPromoted);
+DEFINE_STAT(STAT_PoolBufferBlocksInUse);
+
+CSV_DEFINE_CATEGORY(ObjectPool, true);
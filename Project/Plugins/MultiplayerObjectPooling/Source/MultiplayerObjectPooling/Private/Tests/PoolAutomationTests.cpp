@@ -0,0 +1,139 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Engine.h"
+#include "PoolBenchmark.h"
+#include "PoolInstances.h"
+#include "PoolManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PoolAutomationTests
+{
+	// A game world with a pool manager, it doesn't need a map or a renderer, so the tests also run with -nullrhi
+	class FTestWorld
+	{
+	public:
+
+		FTestWorld() {
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+
+			// There is no game mode which starts the play, the world settings dispatch BeginPlay directly
+			World->GetWorldSettings()->NotifyBeginPlay();
+			PoolManager = World->SpawnActor<APoolManager>();
+		}
+
+		~FTestWorld() {
+			if (IsValid(PoolManager)) {
+				PoolManager->Destroy();
+			}
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		UWorld* World = nullptr;
+
+		APoolManager* PoolManager = nullptr;
+	};
+
+	static const int32 BenchmarkSizes[] = { 10, 100, 1000, 10000, 50000 };
+
+	static constexpr int32 BenchmarkRounds = 3;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPoolResetChecksTest, "Plugins.MultiplayerObjectPooling.ResetChecks", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPoolResetChecksTest::RunTest(const FString& Parameters) {
+	PoolAutomationTests::FTestWorld TestWorld;
+	if (!TestTrue(TEXT("PoolManagerRegistered"), TestWorld.PoolManager != nullptr && APoolManager::GetPoolManager(TestWorld.World) == TestWorld.PoolManager)) return false;
+
+	FPoolBenchmark Benchmark(TestWorld.World);
+	Benchmark.RunResetChecks();
+	for (auto& ResetCheck : Benchmark.GetResetChecks()) {
+		TestTrue(*ResetCheck.Name, ResetCheck.bPassed);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPoolInstanceSetTest, "Plugins.MultiplayerObjectPooling.InstanceSet", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPoolInstanceSetTest::RunTest(const FString& Parameters) {
+	// The bookkeeping of the lightweight instances doesn't need a world
+	FPoolInstanceSet Instances;
+	Instances.Initialize(3);
+	Instances.Reserve(2);
+	TArray<int32> DirtyInstances;
+	Instances.ConsumeDirtyInstances(DirtyInstances);
+	TestTrue(TEXT("InstancesReserved"), Instances.Num() == 2 && Instances.GetNumberOfFreeInstances() == 2 && DirtyInstances.Num() == 2);
+
+	const FTransform Transform(FVector(100.f, 0.f, 0.f));
+	const FPoolInstanceHandle Handle = Instances.Add(Transform, FVector4(1.f, 2.f, 3.f, 4.f));
+	TestTrue(TEXT("InstanceAdded"), Handle.PoolIndex == 3 && Handle.InstanceIndex == 0 && Instances.GetState(Handle) == FPoolInstanceSet::EState::Active);
+	TestTrue(TEXT("InstanceRendered"), Instances.GetRenderTransform(Handle.InstanceIndex).Equals(Transform));
+
+	TestTrue(TEXT("InstancePromoted"), Instances.Promote(Handle) && Instances.GetNumberOfPromotedInstances() == 1 && Instances.GetNumberOfActiveInstances() == 0);
+	TestTrue(TEXT("PromotedInstanceHidden"), Instances.GetRenderTransform(Handle.InstanceIndex).GetScale3D().IsZero());
+	TestTrue(TEXT("PromotedInstanceKeepsPayload"), Instances.GetPayload(Handle) != nullptr && Instances.GetPayload(Handle)->X == 1.f);
+
+	const FTransform DemotedTransform(FVector(200.f, 0.f, 0.f));
+	FTransform InstanceTransform;
+	TestTrue(TEXT("InstanceDemoted"), Instances.Demote(Handle, DemotedTransform) && Instances.GetTransform(Handle, InstanceTransform) && InstanceTransform.Equals(DemotedTransform));
+
+	Instances.ConsumeDirtyInstances(DirtyInstances);
+	TestTrue(TEXT("InstanceDirtyOnce"), DirtyInstances.Num() == 1 && DirtyInstances[0] == Handle.InstanceIndex);
+
+	TestTrue(TEXT("InstanceRemoved"), Instances.Remove(Handle) && Instances.GetNumberOfActiveInstances() == 0);
+	TestTrue(TEXT("StaleInstanceHandle"), !Instances.Remove(Handle) && Instances.GetPayload(Handle) == nullptr && !Instances.SetTransform(Handle, Transform));
+
+	const FPoolInstanceHandle ReusedHandle = Instances.Add(Transform);
+	TestTrue(TEXT("InstanceReused"), ReusedHandle.InstanceIndex == Handle.InstanceIndex && ReusedHandle != Handle && Instances.Num() == 2);
+
+	// The generation mustn't wrap around, a handle stays stale however often its instance is reused
+	FPoolInstanceHandle LastHandle = ReusedHandle;
+	for (int32 i = 0; i < 300; i++) {
+		Instances.Remove(LastHandle);
+		LastHandle = Instances.Add(Transform);
+	}
+	TestTrue(TEXT("StaleHandleAfterManyReuses"), LastHandle.InstanceIndex == Handle.InstanceIndex && Instances.GetPayload(Handle) == nullptr && Instances.GetPayload(ReusedHandle) == nullptr);
+
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FPoolBenchmarkTest, "Plugins.MultiplayerObjectPooling.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FPoolBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const {
+	// Every pool size is a test of its own, the command is the size
+	for (const int32 Size : PoolAutomationTests::BenchmarkSizes) {
+		OutBeautifiedNames.Add(FString::Printf(TEXT("Size %d"), Size));
+		OutTestCommands.Add(FString::FromInt(Size));
+	}
+}
+
+bool FPoolBenchmarkTest::RunTest(const FString& Parameters) {
+	const TArray<int32> Sizes = { FMath::Max(FCString::Atoi(*Parameters), 1) };
+
+	PoolAutomationTests::FTestWorld TestWorld;
+	if (!TestTrue(TEXT("PoolManagerRegistered"), TestWorld.PoolManager != nullptr && APoolManager::GetPoolManager(TestWorld.World) == TestWorld.PoolManager)) return false;
+
+	FPoolBenchmark Benchmark(TestWorld.World);
+	const FString Json = Benchmark.Run(Sizes, PoolAutomationTests::BenchmarkRounds);
+	for (auto& ResetCheck : Benchmark.GetResetChecks()) {
+		TestTrue(*ResetCheck.Name, ResetCheck.bPassed);
+	}
+
+	const FString OutputFile = FPaths::ProfilingDir() / TEXT("PoolBenchmark") / FString::Printf(TEXT("PoolBenchmark-%d-%s.json"), Sizes[0], *FDateTime::Now().ToString());
+	if (TestTrue(TEXT("ResultsWritten"), FFileHelper::SaveStringToFile(Json, *OutputFile))) {
+		AddInfo(FString::Printf(TEXT("Pool benchmark results written to %s"), *OutputFile));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,124 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Thread safe pool for raw memory blocks below the UObject level, e.g. network buffers and POD structs.
+ * The blocks are grouped into power of two size classes (64 bytes up to 32 KB). Every size class is a lock free
+ * fixed size allocator with a cache per thread, so encoding and decoding on worker threads doesn't allocate in
+ * steady state. Larger requests fall back to FMemory.
+ */
+class MULTIPLAYEROBJECTPOOLING_API FPoolBufferAllocator
+{
+public:
+
+	static constexpr int32 MinBlockSize = 64;
+	static constexpr int32 MaxBlockSize = 32 * 1024;
+	static constexpr int32 NumberOfSizeClasses = 10;
+
+	// The blocks are aligned to at least this amount of bytes
+	static constexpr int32 Alignment = 16;
+
+	/*
+	* Get a block with at least the given size
+	* @param Size	The number of bytes
+	* @return The block, its capacity is GetBlockSize(Size)
+	*/
+	static void* Allocate(int32 Size);
+
+	/*
+	* Give the block back to its size class
+	* @param Block	A block of Allocate
+	* @param Size	The size which has been passed to Allocate, or the capacity of the block
+	*/
+	static void Free(void* Block, int32 Size);
+
+	// The capacity of the blocks which are used for the given size
+	static int32 GetBlockSize(int32 Size);
+
+	// Returns INDEX_NONE for sizes which are too large for the pool
+	static int32 GetSizeClass(int32 Size);
+
+	struct FSizeClassStats {
+		int32 BlockSize;
+		int32 NumberOfUsedBlocks;
+		int32 HighWaterMark;
+		int32 Allocations;
+	};
+
+	// A snapshot of the counters of all size classes. The last entry contains the allocations which were too large
+	static void GetStats(TArray<FSizeClassStats>& OutStats);
+
+	static int32 GetNumberOfUsedBlocks();
+
+	static void DumpStats(FOutputDevice& Ar);
+};
+
+/**
+ * A growable byte buffer whose memory comes from the buffer pool. It can be moved, but not copied
+ */
+class MULTIPLAYEROBJECTPOOLING_API FPooledBuffer
+{
+public:
+
+	FPooledBuffer() {}
+
+	explicit FPooledBuffer(int32 InitialCapacity) { Reserve(InitialCapacity); }
+
+	FPooledBuffer(FPooledBuffer&& Other);
+	FPooledBuffer& operator=(FPooledBuffer&& Other);
+
+	FPooledBuffer(const FPooledBuffer&) = delete;
+	FPooledBuffer& operator=(const FPooledBuffer&) = delete;
+
+	~FPooledBuffer() { Release(); }
+
+	uint8* GetData() { return Data; }
+	const uint8* GetData() const { return Data; }
+
+	int32 Num() const { return Size; }
+
+	int32 GetCapacity() const { return Capacity; }
+
+	// Make sure that the buffer can hold the given number of bytes, the content is kept
+	void Reserve(int32 NewCapacity);
+
+	// Change the number of bytes, new bytes are uninitialized
+	void SetNumUninitialized(int32 NewSize);
+
+	void Append(const void* Source, int32 Count);
+
+	// Remove the content, the memory block is kept
+	void Reset() { Size = 0; }
+
+	// Give the memory block back to the pool
+	void Release();
+
+	TArrayView<uint8> GetView() { return TArrayView<uint8>(Data, Size); }
+
+private:
+
+	uint8* Data = nullptr;
+
+	int32 Size = 0;
+
+	int32 Capacity = 0;
+};
+
+// Construct a POD struct inside a pooled block
+template<typename T, typename... ArgsType>
+T* NewPooled(ArgsType&&... Args) {
+	static_assert(TIsPODType<T>::Value, "Only POD structs can be pooled");
+	static_assert(alignof(T) <= FPoolBufferAllocator::Alignment, "The alignment of the struct is too large for the buffer pool");
+	return new (FPoolBufferAllocator::Allocate(sizeof(T))) T{ Forward<ArgsType>(Args)... };
+}
+
+// Give the block of a POD struct of NewPooled back to the pool
+template<typename T>
+void DeletePooled(T* Object) {
+	if (Object != nullptr) {
+		FPoolBufferAllocator::Free(Object, sizeof(T));
+	}
+}
@@ -0,0 +1,196 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "UObject/Package.h"
+#include "PoolClassDefaults.h"
+#include "PoolStats.h"
+
+// Reset policy which leaves the released objects untouched
+struct FObjectPoolNoReset
+{
+	void Initialize(UClass* Class) {}
+
+	void Reset(UObject* Object) {}
+};
+
+// Reset policy which restores the diverged properties of the class default object (the same as the pool holder does)
+struct FObjectPoolSnapshotReset
+{
+	void Initialize(UClass* Class) { ClassDefaults = FPoolClassDefaultsRegistry::Get(Class); }
+
+	void Reset(UObject* Object) { ClassDefaults->Properties.RestoreDirty(Object); }
+
+private:
+
+	// Shared with the pool holders and the other native pools of the class
+	TSharedPtr<const FPoolClassDefaults> ClassDefaults;
+};
+
+// Reset policy which calls the member function "void ResetPooledObject()" of the pooled class
+struct FObjectPoolMemberReset
+{
+	void Initialize(UClass* Class) {}
+
+	template<typename T>
+	void Reset(T* Object) { Object->ResetPooledObject(); }
+};
+
+/**
+ * The untyped part of the native object pools. Every native pool registers itself to show up in the pool stats
+ */
+class MULTIPLAYEROBJECTPOOLING_API FObjectPoolBase
+{
+public:
+
+	FObjectPoolBase(UClass* InClass);
+	virtual ~FObjectPoolBase();
+
+	UClass* GetPoolClass() const { return Class; }
+
+	virtual int32 GetNumberOfUsedObjects() const = 0;
+
+	virtual int32 GetNumberOfAvailableObjects() const = 0;
+
+	const FPoolStats& GetStats() const { return Stats; }
+
+	// Add the current state of the pool to the csv profiler, called once per frame
+	void PublishStats() const;
+
+	// All native pools which are alive, only accessed on the game thread
+	static const TArray<FObjectPoolBase*>& GetRegisteredPools() { return RegisteredPools; }
+
+protected:
+
+	UClass* Class;
+
+	FPoolStats Stats;
+
+private:
+
+	static TArray<FObjectPoolBase*> RegisteredPools;
+
+#if CSV_PROFILER
+	FName CsvStatNameInUse;
+	FName CsvStatNameAvailable;
+#endif
+};
+
+/**
+ * A lightweight pool for plain UObjects which doesn't need the pool manager or a pool holder actor.
+ * It can be a member of any gameplay system, the available objects are kept alive by the garbage collector hook.
+ * The acquired objects have to be referenced by their user until they are released.
+ * @param T				The pooled class
+ * @param ResetPolicy	Resets the objects when they are released, see FObjectPoolSnapshotReset, FObjectPoolMemberReset and FObjectPoolNoReset
+ */
+template<typename T, typename ResetPolicy = FObjectPoolSnapshotReset>
+class TObjectPool : public FObjectPoolBase, public FGCObject
+{
+	static_assert(TIsDerivedFrom<T, UObject>::IsDerived, "TObjectPool can only pool UObjects");
+
+public:
+
+	/*
+	* @param InitialSize	The number of objects which are created right away
+	* @param InClass		The pooled class, has to be a child of T
+	* @param InOuter		The outer of the created objects
+	*/
+	explicit TObjectPool(int32 InitialSize = 0, UClass* InClass = T::StaticClass(), UObject* InOuter = GetTransientPackage())
+		: FObjectPoolBase(InClass)
+		, Outer(InOuter)
+	{
+		check(InClass->IsChildOf(T::StaticClass()));
+		Policy.Initialize(InClass);
+		Reserve(InitialSize);
+	}
+
+	virtual ~TObjectPool() {}
+
+	// Get an object from the pool, a new object is created if the pool is empty or only holds invalid objects
+	T* Acquire() {
+		SCOPE_CYCLE_COUNTER(STAT_PoolAcquire);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		// The garbage collector clears the objects which have been marked pending kill, objects which have been renamed into another outer aren't a part of the pool anymore
+		T* Object = nullptr;
+		while (Object == nullptr && AvailableObjects.Num() > 0) {
+			Object = AvailableObjects.Pop(false);
+			if (!IsValid(Object) || Object->GetOuter() != Outer) {
+				Object = nullptr;
+			}
+		}
+
+		if (Object != nullptr) {
+			Stats.Hits++;
+		}
+		else {
+			Object = CreateObject();
+			Stats.OnDemandCreations++;
+			INC_DWORD_STAT(STAT_PoolOnDemandCreations);
+		}
+		NumberOfUsedObjects++;
+
+		Stats.Acquires++;
+		Stats.PeakInUse = FMath::Max(Stats.PeakInUse, NumberOfUsedObjects);
+		Stats.AcquireCycles += FPlatformTime::Cycles64() - StartCycles;
+		INC_DWORD_STAT(STAT_PoolAcquires);
+		return Object;
+	}
+
+	// Reset the object and make it available again. It must not be used afterwards
+	void Release(T* Object) {
+		if (Object == nullptr) return;
+		checkSlow(!AvailableObjects.Contains(Object));
+
+		SCOPE_CYCLE_COUNTER(STAT_PoolRelease);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		// Reset on release, so the pooled objects don't keep anything alive
+		Policy.Reset(Object);
+		AvailableObjects.Push(Object);
+		NumberOfUsedObjects--;
+
+		Stats.Releases++;
+		Stats.ReleaseCycles += FPlatformTime::Cycles64() - StartCycles;
+		INC_DWORD_STAT(STAT_PoolReleases);
+	}
+
+	// Create objects until the pool contains the given number of available objects
+	void Reserve(int32 Quantity) {
+		AvailableObjects.Reserve(Quantity);
+		while (AvailableObjects.Num() < Quantity) {
+			AvailableObjects.Push(CreateObject());
+		}
+	}
+
+	// Forget all available objects, the garbage collector will remove them
+	void Empty() {
+		AvailableObjects.Empty();
+	}
+
+	virtual int32 GetNumberOfUsedObjects() const override { return NumberOfUsedObjects; }
+
+	virtual int32 GetNumberOfAvailableObjects() const override { return AvailableObjects.Num(); }
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override {
+		Collector.AddReferencedObjects(AvailableObjects);
+		Collector.AddReferencedObject(Outer);
+	}
+
+private:
+
+	// The available objects are used as a stack to reuse the most recently released (cache warm) object first
+	TArray<T*> AvailableObjects;
+
+	UObject* Outer;
+
+	int32 NumberOfUsedObjects = 0;
+
+	ResetPolicy Policy;
+
+	T* CreateObject() {
+		return NewObject<T>(Outer, Class, NAME_None, RF_Transient);
+	}
+};
@@ -0,0 +1,145 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/GCObject.h"
+#include "PoolSnapshot.h"
+#include "PoolClassDefaults.generated.h"
+
+class UActorComponent;
+class AActor;
+
+// Used to remember the default object settings
+USTRUCT()
+struct FDefaultObjectSettings {
+	GENERATED_BODY()
+
+public:
+
+	FDefaultObjectSettings()
+		: Class(nullptr)
+		, TickInterval(0.f)
+		, LifeSpan(0.f)
+		, bImplementsPoolableInterface(false)
+		, bIsActor(false)
+		, bStartWithTickEnabled(false)
+		, bHiddenInGame(false)
+		, bCanBeDamaged(false)
+	{}
+
+	UClass* Class;
+
+	// Actor Settings
+
+	float TickInterval;
+	float LifeSpan;
+
+	// The flags are packed into a single byte
+	uint8 bImplementsPoolableInterface : 1;
+	uint8 bIsActor : 1;
+	uint8 bStartWithTickEnabled : 1;
+	uint8 bHiddenInGame : 1;
+	uint8 bCanBeDamaged : 1;
+};
+
+// Used to remember the default objects components settings
+USTRUCT()
+struct FDefaultComponentSettings {
+	GENERATED_BODY()
+
+public:
+
+	FDefaultComponentSettings()
+		: TickInterval(0.f)
+		, bImplementsPoolableInterface(false)
+		, bStartWithTickEnabled(false)
+		, bAutoActivate(false)
+		, bIsSceneComponent(false)
+		, bIsVisible(false)
+		, bIsHidden(false)
+		, bIsStaticMeshComponent(false)
+		, bIsSimulatingPhysics(false)
+	{}
+
+	// SceneComponent Settings
+	FTransform RelativeTransform;
+
+	// The gameplay properties of the component
+	FPoolPropertySnapshot Properties;
+
+	TArray<FName> Tags;
+
+	// The components are matched by their name, which is unique inside the actor
+	FName Name;
+
+	float TickInterval;
+
+	// ActorComponent Settings
+	uint8 bImplementsPoolableInterface : 1;
+	uint8 bStartWithTickEnabled : 1;
+	uint8 bAutoActivate : 1;
+
+	// SceneComponent Settings
+	uint8 bIsSceneComponent : 1;
+	uint8 bIsVisible : 1;
+	uint8 bIsHidden : 1;
+
+	// StaticMeshComponent Settings
+	uint8 bIsStaticMeshComponent : 1;
+	uint8 bIsSimulatingPhysics : 1;
+};
+
+// The default settings of a pooled class and its components, shared by all pools of the class in all worlds
+struct FPoolClassDefaults : public FGCObject {
+	FDefaultObjectSettings ObjectSettings;
+
+	// Only filled for actor classes
+	TArray<FDefaultComponentSettings> ComponentsSettings;
+
+	// The gameplay properties of the class default object
+	FPoolPropertySnapshot Properties;
+
+	// The class default object the settings have been derived from, a reinstanced class gets a new one
+	FObjectKey DefaultObject;
+
+	// True if the settings have been captured from a spawned actor, so they contain the values of its construction scripts
+	bool bFromConstructedActor = false;
+
+	// Keeps the objects alive which are referenced by the captured properties, e.g. assets
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+};
+
+/**
+ * Derives the default settings of the pooled classes from their class default objects and component templates, without spawning any actor.
+ * Actor pools replace them with the settings of their first spawned actor, which contain the values of the construction scripts. Every class is only evaluated once per process, all pools of all worlds share the result. The settings are derived again after the class
+ * has been reinstanced (blueprint compile or hot reload), which is detected by its new class default object. Only used on the game thread.
+ */
+class MULTIPLAYEROBJECTPOOLING_API FPoolClassDefaultsRegistry
+{
+public:
+
+	// Get the default settings of the class, they are derived on the first request
+	static TSharedRef<const FPoolClassDefaults> Get(UClass* Class);
+
+	// Capture the settings of the actor and its components after its construction scripts have run, they replace the settings of its class
+	static TSharedRef<const FPoolClassDefaults> CaptureConstructedActor(const AActor* Actor);
+
+	// Forget all classes, the pools which use the settings keep them alive
+	static void Empty();
+
+	static int32 Num() { return ClassesToDefaults.Num(); }
+
+private:
+
+	static TMap<FObjectKey, TSharedPtr<const FPoolClassDefaults>> ClassesToDefaults;
+
+	static void AddActorDefaults(UClass* Class, FPoolClassDefaults& Defaults);
+
+	// The owner is the actor of a spawned component, references to the actor and its other components aren't captured
+	static void AddComponentSettings(const UActorComponent* Template, FName Name, FPoolClassDefaults& Defaults, const AActor* Owner = nullptr);
+
+	// Forget the classes which have been unloaded
+	static void RemoveStaleClasses();
+};
@@ -6,8 +6,48 @@
 #include "GameFramework/Actor.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Runtime/Engine/Classes/Engine/DataTable.h"
+#include "PoolClassDefaults.h"
+#include "PoolStats.h"
+#include "PoolInstances.h"
 #include "PoolHolder.generated.h"
 
+class UStaticMesh;
+class UInstancedStaticMeshComponent;
+
+UENUM(BlueprintType)
+enum class EPoolDeactivationStrategy : uint8 {
+	FULL_DISABLE		UMETA(DisplayName = "FullDisable", ToolTip = "Attach the actor to the pool, hide it and disable its collision and tick. Physics bodies are recreated on every activation."),
+	HIDE_ONLY			UMETA(DisplayName = "HideOnly", ToolTip = "Only hide the actor and disable its tick. Collision and physics stay untouched."),
+	PARK_OFF_WORLD		UMETA(DisplayName = "ParkOffWorld", ToolTip = "Keep the physics state, but move the actor to the parking location and put its bodies to sleep.")
+};
+
+// Lets the pool grow and shrink with the demand. All amounts are in objects
+USTRUCT(BlueprintType)
+struct FPoolSizingPolicy
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "Adapt the size of the pool to the demand. AmountOfObjects is used as the initial size"))
+		bool bEnabled = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The pool never shrinks below this amount of objects", ClampMin = "0"))
+		int32 MinObjects = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The pool never grows above this amount of objects, neither by the adaptive sizing nor by CreateAndAdd (0 = unlimited)", ClampMin = "0"))
+		int32 MaxObjects = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The amount of objects which are created at once when the pool grows", ClampMin = "1"))
+		int32 GrowthChunkSize = 10;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The desired amount of available objects relative to the used objects (at least one growth chunk). The pool grows below half of it and shrinks above twice of it", ClampMin = "0"))
+		float TargetHeadroomRatio = 0.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The time in seconds the pool has to be idle above its high watermark before objects are destroyed", ClampMin = "0"))
+		float ShrinkCooldown = 10.f;
+};
+
 USTRUCT(BlueprintType)
 struct FPoolEntry : public FTableRowBase
 {
@@ -18,67 +58,161 @@ public:
 	FPoolEntry()
 		: Class(UObject::StaticClass())
 		, AmountOfObjects(100)
+		, WarmUpPriority(0)
+		, bLoadOnFirstAcquire(false)
+		, bReleaseAssetsOnEmpty(false)
+		, DeactivationStrategy(EPoolDeactivationStrategy::FULL_DISABLE)
+		, ParkingLocation(0.f, 0.f, 500000.f)
+		, ParkingSpacing(1000.f)
+		, bCloneFromTemplate(true)
+		, bBatchedUpdate(false)
+		, MemoryBudgetKB(0)
+		, InstancedMesh(nullptr)
+		, AmountOfInstances(0)
 	{}
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool")
 		UClass* Class;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "If set, the class is loaded asynchronously and used instead of Class. The pool is created as soon as the class is loaded"))
+		TSoftClassPtr<UObject> SoftClass;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The number of objects you want to have inside the pool"))
 		int32 AmountOfObjects;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "Pools with a higher priority are created and filled first"))
+		int32 WarmUpPriority;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "Don't load the soft class until an object of the pool is requested by class or by handle (or RequestPoolLoad is called). Requests by handle return nothing until the class is loaded"))
+		bool bLoadOnFirstAcquire;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "Release the loaded soft class and its assets when the pool gets emptied"))
+		bool bReleaseAssetsOnEmpty;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "How the actors are deactivated when they are returned to the pool"))
+		EPoolDeactivationStrategy DeactivationStrategy;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "Where the deactivated actors are parked with the strategy ParkOffWorld. They fill a grid which grows away from the world origin and stays inside the world bounds"))
+		FVector ParkingLocation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The distance between the parked actors, to keep their sleeping bodies from touching each other"))
+		float ParkingSpacing;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "Spawn the actors from a deactivated template, so their components are registered without render and physics state"))
+		bool bCloneFromTemplate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "Update all active objects with a single tick of the pool instead of their own ticks. The pool moves them by their velocity and calls the native PoolableUpdate of the PoolableInterface"))
+		bool bBatchedUpdate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The memory in kilobytes the objects of the pool may pin. The pool doesn't grow above it and destroys available objects which exceed it (0 = unlimited)", ClampMin = "0"))
+		int32 MemoryBudgetKB;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "If set, the pool can hold lightweight instances of this mesh without any actor (SpawnInstanceFromPool). An instance is promoted to an actor of the pool when the gameplay needs it and demoted afterwards. Only for actor classes"))
+		UStaticMesh* InstancedMesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "The number of hidden instances which are created right away, the instances grow on demand", ClampMin = "0"))
+		int32 AmountOfInstances;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool", Meta = (ToolTip = "If set, the pool only exists while this streaming level is loaded. It is warmed up when the level starts loading and drained when the level gets unloaded"))
+		TSoftObjectPtr<UWorld> StreamingLevel;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Object Pool")
+		FPoolSizingPolicy SizingPolicy;
+
+	bool UsesSoftClass() const { return !SoftClass.IsNull(); }
+
+	bool IsLevelScoped() const { return !StreamingLevel.IsNull(); }
 };
 
-// Used to remember the default object settings
-USTRUCT()
-struct FDefaultObjectSettings {
+/**
+ * Identifies a pooled object by its pool, its slot and the generation of the slot, packed into 32 bits.
+ * The generation increases every time the slot becomes available, so an id of an object which has been returned
+ * in the meantime doesn't resolve anymore. Objects of pools beyond MaxPools or of slots beyond MaxSlots don't get an id.
+ * The ids are only identical on all peers if:
+ * - The pools have the same indices. The pools of the data table are indexed in the order of their warm up priority,
+ *   rows with the same priority keep the table order. Rows which are added while the game runs get the next free index
+ *   and pools which are added with AddObjectPool get their index in call order.
+ * - The pools have finished their warm up and have a fixed size. The adaptive sizing, the memory budgets and the growth
+ *   on demand (CreateAndAdd or acquires during the warm up) create and destroy slots depending on the timing of each peer.
+ * - Every peer acquires and returns the same objects of the pool in the same order.
+ * GetObjectId warns once per pool whose slots aren't fixed.
+ */
+USTRUCT(BlueprintType, Category = "Object Pool")
+struct FPoolObjectId {
 	GENERATED_BODY()
 
 public:
-	// Object Settings
 
-	bool bImplementsPoolableInterface;
-	UClass* Class;
+	static constexpr int32 MaxPools = 0xFF;
+	static constexpr int32 MaxSlots = 0xFFFF;
 
-	// Actor Settings
+	FPoolObjectId()
+		: Id(INDEX_NONE)
+	{}
 
-	bool bIsActor;
-	bool bStartWithTickEnabled;
-	float TickInterval;
-	bool bHiddenInGame;
-	float LifeSpan;
-	bool bCanBeDamaged;
+	// Negative indices (INDEX_NONE) result in an invalid id, they would alias the id of a real object otherwise
+	FPoolObjectId(int32 PoolIndex, int32 SlotIndex, uint8 Generation)
+		: Id(PoolIndex >= 0 && PoolIndex < MaxPools && SlotIndex >= 0 && SlotIndex < MaxSlots ? (int32)(((uint32)PoolIndex << 24) | ((uint32)SlotIndex << 8) | Generation) : INDEX_NONE)
+	{}
 
+	bool IsValid() const { return Id != INDEX_NONE; }
+
+	int32 GetPoolIndex() const { return (int32)((uint32)Id >> 24); }
+
+	int32 GetSlotIndex() const { return (int32)(((uint32)Id >> 8) & 0xFFFF); }
+
+	uint8 GetGeneration() const { return (uint8)(Id & 0xFF); }
+
+	bool operator==(const FPoolObjectId& Other) const { return Id == Other.Id; }
+	bool operator!=(const FPoolObjectId& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FPoolObjectId& ObjectId) { return GetTypeHash(ObjectId.Id); }
+
+	// Pool index (8 bit), slot index (16 bit) and generation (8 bit)
+	UPROPERTY()
+		int32 Id;
 };
 
-// Used to remember the default objects components settings
+// A single entry of the pool. The available slots are linked to an intrusive free list, the used slots to a list in acquire order
 USTRUCT()
-struct FDefaultComponentSettings {
+struct FPoolSlot {
 	GENERATED_BODY()
 
 public:
-	// ActorComponent Settings
-
-	bool bImplementsPoolableInterface;
-	bool bStartWithTickEnabled;
-	float TickInterval;
-	TArray<FName> Tags;
-	bool bAutoActivate;
-
-	// SceneComponent Settings
-	bool bIsSceneComponent;
-	FTransform RelativeTransform;
-	bool bIsVisible;
-	bool bIsHidden;
-
-	// StaticMeshComponent Settings
-	bool bIsStaticMeshComponent;
-	bool bIsSimulatingPhysics;
+
+	UPROPERTY()
+		UObject* Object = nullptr;
+
+	// The keys of the slot inside the lookup maps. They stay set after the garbage collector has cleared the object, so the slot can still be unregistered
+	UObject* Key = nullptr;
+	FName Name;
+
+	// The previous and next slot inside the free or used list (INDEX_NONE if there is none). Dead slots are linked by Next
+	int32 Prev = INDEX_NONE;
+	int32 Next = INDEX_NONE;
+
+	// The world time when the object has been taken out of the pool
+	float AcquireTime = 0.f;
+
+	// Increased every time the slot becomes available or its object gets destroyed
+	uint8 Generation = 0;
+
+	bool bIsAvailable = false;
+
+	// Taken out of the pool by a deferred spawn which hasn't been finished yet
+	bool bIsActivationDeferred = false;
+
+	// The index inside the batched update arrays of the pool while the object is active (INDEX_NONE if it isn't updated by the pool)
+	int32 BatchIndex = INDEX_NONE;
 };
 
+class IPoolableInterface;
+
 /**
  * Stores all the objects inside the specified pool
  */
 UCLASS()
-class APoolHolder : public AActor
+class MULTIPLAYEROBJECTPOOLING_API APoolHolder : public AActor
 {
 	GENERATED_BODY()
 	
@@ -92,59 +226,443 @@ public:
 	// Get an unused object from the pool
 	UObject* GetUnused();
 
-	// Creates a new instance for the object and returns it
+	/*
+	* Creates a new object, adds it to the pool and takes it
+	* @return The new object or nullptr if the pool has reached its maximum size or its memory budget
+	*/
 	UObject* GetNew();
 
 	// Get all unused objects from the pool
 	TArray<UObject*> GetAllUnused();
 
+	/*
+	* Return the object which has been in use for the longest time to the pool and take it again
+	* @return The recycled object or nullptr if no object is in use
+	*/
+	UObject* RecycleOldest();
+
+	/*
+	* Recycle the objects which have been in use for the longest time
+	* @param Quantity	The maximum number of recycled objects
+	* @param OutObjects	The objects are appended to this array
+	* @return The number of objects which have been recycled
+	*/
+	int32 RecycleOldest(int32 Quantity, TArray<UObject*>& OutObjects);
+
+	/*
+	* Get multiple unused objects from the pool at once
+	* @param Quantity	The number of desired objects
+	* @param OutObjects	The objects are appended to this array
+	* @param bGrow		Create the missing objects in one step and add them to the pool, as far as the pool can grow
+	* @return The number of objects which have been appended
+	*/
+	int32 GetUnused(int32 Quantity, TArray<UObject*>& OutObjects, bool bGrow);
+
 	// Get a specific object by its name
 	UObject* GetSpecific(FString ObjectName);
 
+	// Get a specific object by its name, without any string operations
+	UObject* GetSpecific(FName ObjectName);
+
+	// Get a specific object by its id, the slot has to be available and of the same generation
+	UObject* GetSpecific(FPoolObjectId ObjectId);
+
+	// Returns an invalid id if the object isn't a part of this pool or its slot doesn't fit into an id
+	FPoolObjectId GetObjectId(UObject* Object) const;
+
+	/*
+	* Warn once if the slots of the pool are created or destroyed depending on the timing, so the ids can differ between the peers
+	* @param bIsTrimmedByGlobalBudget	True if the pool manager destroys objects to keep its global memory budget
+	*/
+	void CheckStableIds(bool bIsTrimmedByGlobalBudget) const;
+
+	// Returns nullptr if the id doesn't belong to this pool or is stale
+	UObject* GetObjectById(FPoolObjectId ObjectId) const;
+
+	// The index of the pool inside the pool manager, it is a part of the object ids
+	void SetPoolIndex(int32 InPoolIndex) { PoolIndex = InPoolIndex; }
+
+	int32 GetPoolIndex() const { return PoolIndex; }
+
 	int32 GetNumberOfUsedObjects();
 
+	// Returns true if any used object still exists, the objects which have been destroyed by the gameplay don't count
+	bool HasObjectsInUse() const;
+
+	// Returns true if the object has a slot in this pool, no matter if it is used or available
+	bool ContainsObject(UObject* Object) const { return FindSlot(Object) != INDEX_NONE; }
+
+	// Write the generations of all slots, the slots which this pool doesn't have keep their generation
+	void StoreSlotGenerations(TArray<uint8>& InOutGenerations) const;
+
+	/*
+	* Start the slots after the generations of a pool which had the same index before, so the ids of its objects don't resolve to the objects of this pool.
+	* Has to be called before any object is added
+	*/
+	void ContinueSlotGenerations(const TArray<uint8>& Generations) { ContinuedSlotGenerations = Generations; }
+
+	UClass* GetPoolClass() const { return DefaultObjectSettings.Class; }
+
 	int32 GetNumberOfAvailableObjects();
 
 	// Return an object to the pool
 	UFUNCTION()
 	void ReturnObject(UObject* Object);
 
+	// Return multiple objects to the pool. Objects which are returned more than once are only deactivated once
+	void ReturnObjects(TArrayView<UObject*> Objects);
+
 	// Initialize the pool with a given class and the amount of objects that the pool will contain
 	void InitializePool(FPoolEntry PoolEntry);
 
+	// Initialize the pool without creating any objects, call WarmUp afterwards to fill the pool
+	void BeginInitializePool(const FPoolEntry& PoolEntry);
+
+	/*
+	* Create objects until the pool contains the desired amount of objects, the time runs out or a memory budget is reached.
+	* A pool which stops at a memory budget counts as warmed up, it won't grow any further
+	* @param EndTime	The platform time in seconds when the warm up has to stop
+	* @param RemainingBudgetBytes	The bytes which are left of the global memory budget of the pool manager
+	* @return True if the pool is completely warmed up
+	*/
+	bool WarmUp(double EndTime, int64 RemainingBudgetBytes = TNumericLimits<int64>::Max());
+
+	// Stays true after the pool has been filled once, even if the pool shrinks afterwards
+	bool IsWarmedUp() const { return bIsWarmedUp; }
+
+	// Fill the pool up to its desired amount of objects again with the next warm up
+	void ResetWarmUp() { bIsWarmedUp = false; }
+
+	/*
+	* Apply the sizes of a changed pool entry without rebuilding the pool. The pool grows with its next warm up and shrinks over the next frames
+	* @param PoolEntry	Only the amount of objects, the sizing policy and the memory budget are used
+	*/
+	void ResizePool(const FPoolEntry& PoolEntry);
+
+	/*
+	* Destroy the available objects which exceed the desired amount of objects since the last resize
+	* @return The number of destroyed objects
+	*/
+	int32 ShrinkToDesiredSize(double EndTime);
+
+	int32 GetNumberOfObjects() const { return Slots.Num() - NumberOfDeadSlots; }
+
+	bool UsesAdaptiveSize() const { return SizingPolicy.bEnabled; }
+
+	/*
+	* Grow or shrink the pool towards its sizing policy
+	* @param DeltaSeconds	The time since the last update, used for the shrink cooldown
+	* @param EndTime		The platform time in seconds when the update has to stop
+	*/
+	void UpdateSize(float DeltaSeconds, double EndTime);
+
+	/*
+	* Destroy available objects, the objects which have been unused for the longest time are destroyed first
+	* @return The number of destroyed objects
+	*/
+	int32 DestroyUnused(int32 Quantity, double EndTime = TNumericLimits<double>::Max());
+
+	// The memory which is pinned by the objects of the pool, estimated with the size of the first object
+	int64 GetMemoryBytes() const { return BytesPerObject * GetNumberOfObjects(); }
+
+	// The size of a single object and its components, without the shared assets
+	int64 GetBytesPerObject() const { return BytesPerObject; }
+
+	/*
+	* Destroy available objects until the pool fits into the memory budget of its pool entry
+	* @return The number of destroyed objects
+	*/
+	int32 TrimToMemoryBudget(double EndTime);
+
+	// Used by the pool manager to stop the growth while all pools together exceed their memory budget
+	void SetGrowthAllowed(bool bInIsGrowthAllowed) { bIsGrowthAllowed = bInIsGrowthAllowed; }
+
+	int32 GetDesiredNumberOfObjects() const { return DesiredNumberOfObjects; }
+
 	bool IsObjectAvailable(UObject* Object);
 
+	// The life span of the pool class, the objects are returned to the pool instead of being destroyed
+	float GetLifeSpan() const { return DefaultObjectSettings.LifeSpan; }
+
+	/*
+	* Return all objects whose life span has run out, called once per frame by the pool manager
+	* @param WorldTime	The current world time in seconds
+	* @return The number of returned objects
+	*/
+	int32 ReturnExpiredObjects(float WorldTime);
+
+	const FPoolStats& GetStats() const { return Stats; }
+
+	FPoolStats& GetMutableStats() { return Stats; }
+
+	// Add the current state of the pool to the csv profiler, called once per frame
+	void PublishStats();
+
 	virtual void Destroyed() override;
 
+	// Updates the active objects of a pool with a batched update
+	virtual void Tick(float DeltaSeconds) override;
+
 	/*
 	* Activate or deactivate the object. On activation it will restore the default values
 	* @param Object
 	* @param bIsActive
+	* @param bRestoreDefaults	Restore the default values on activation, otherwise the current values are kept
+	*/
+	void SetObjectActive(UObject* Object, bool bIsActive = true, bool bRestoreDefaults = true);
+
+	// Deactivate the objects step by step for all of them, so the render and physics state of the batch changes together
+	void DeactivateObjects(TArrayView<UObject*> Objects);
+
+	// Restore the cached default values of the object without activating it
+	void RestoreDefaults(UObject* Object);
+
+	// Mark the used object as taken by a deferred spawn, it gets activated by FinishDeferredActivation
+	void BeginDeferredActivation(UObject* Object);
+
+	// Returns true if the object has been taken by a deferred spawn and clears the mark. It's false for objects which are already active or have been returned
+	bool FinishDeferredActivation(UObject* Object);
+
+	bool IsActivationDeferred(UObject* Object) const;
+
+	// True if the pool holds lightweight instances of the instanced mesh of its pool entry
+	bool UsesInstances() const { return InstancedMeshComponent != nullptr; }
+
+	const FPoolInstanceSet& GetInstances() const { return Instances; }
+
+	FPoolInstanceSet& GetMutableInstances() { return Instances; }
+
+	/*
+	* Add a lightweight instance which is only rendered by the instanced mesh of the pool
+	* @param Payload	Gameplay data of the instance, e.g. a velocity and a life span
+	* @return An invalid handle if the pool doesn't use instances
+	*/
+	FPoolInstanceHandle AddInstance(const FTransform& Transform, const FVector4& Payload = FVector4(0.f, 0.f, 0.f, 0.f));
+
+	// Free the instance, the actor of a promoted instance is returned to the pool
+	bool RemoveInstance(FPoolInstanceHandle Handle);
+
+	/*
+	* Let the actor represent the active instance, the instance is hidden until the actor gets demoted
+	* @param Actor	An acquired actor of this pool, it is moved to the transform of the instance
 	*/
-	void SetObjectActive(UObject* Object, bool bIsActive = true);
+	bool PromoteInstance(FPoolInstanceHandle Handle, AActor* Actor);
+
+	/*
+	* Return the actor to the pool and show its instance at the transform of the actor again
+	* @return The handle of the instance. An actor which hasn't been promoted gets a new instance
+	*/
+	FPoolInstanceHandle DemoteActor(AActor* Actor);
+
+	// Returns nullptr if the instance isn't promoted
+	AActor* GetPromotedActor(FPoolInstanceHandle Handle) const;
+
+	// Send the instances which have changed since the last flush to the instanced mesh, called once per frame by the pool manager
+	void FlushInstances();
 
 private:
 
-	// Contains all the objects of this pool
-	UPROPERTY(EditAnywhere)
-		TMap<FString, UObject*> ObjectPool;
+	// Contains all the objects of this pool, an object keeps its slot as long as it is part of the pool
+	UPROPERTY()
+		TArray<FPoolSlot> Slots;
+
+	// The last generations of the slots of the previous pool at the same index, new slots start after them
+	TArray<uint8> ContinuedSlotGenerations;
 
-	// Contains all available object names
-	UPROPERTY(EditAnywhere)
-		TArray<FString> AvailableObjects;
+	// Maps every pooled object to its slot
+	TMap<UObject*, int32> ObjectsToSlots;
+
+	// Maps the object names to their slots, only used to find specific objects
+	TMap<FName, int32> NamesToSlots;
+
+	// The first and last slot of the free list (INDEX_NONE if the pool is empty). Returned objects are added to the front
+	int32 FirstFreeSlot = INDEX_NONE;
+	int32 LastFreeSlot = INDEX_NONE;
+
+	int32 NumberOfAvailableObjects = 0;
+
+	// The number of slots which are marked as taken by a deferred spawn, the activation only looks up the slot if there are any
+	int32 NumberOfDeferredActivations = 0;
+
+	// The first and last slot of the used list. The used objects are ordered by their acquire time, the oldest comes first
+	int32 FirstUsedSlot = INDEX_NONE;
+	int32 LastUsedSlot = INDEX_NONE;
+
+	// Slots of destroyed objects, they are reused before the slot array grows
+	int32 FirstDeadSlot = INDEX_NONE;
+
+	int32 NumberOfDeadSlots = 0;
+
+	FPoolSizingPolicy SizingPolicy;
+
+	// The time the pool has spent above its high watermark
+	float TimeAboveHighWatermark = 0.f;
+
+	// True while the pool grows towards its desired amount of available objects
+	bool bIsGrowing = false;
 
 	// Saves the default object settings to restore them, when the object is pulled from the pool
 	FDefaultObjectSettings DefaultObjectSettings;
 
-	// Saves the default object components settings to restore them, when the object is pulled from the pool
-	TArray<FDefaultComponentSettings> DefaultComponentsSettings;
-
-	// This is only used when the object has a life span and triggers the return to pool function when the object dies
-	TMap<UObject*, FTimerHandle> ObjectsToTimers;
+	// The default settings of the class, its components and its gameplay properties. Shared with all pools of the class, only the diverged properties are restored
+	TSharedPtr<const FPoolClassDefaults> ClassDefaults;
 
 	// Necessary for the objects which are getting deactivated but don't call the interface function PoolableEndPlay
 	bool bIsPoolHolderInitialized = false;
 
+	// The amount of objects defined by the pool entry
+	int32 DesiredNumberOfObjects = 0;
+
+	// The objects which still have to be destroyed after the pool entry has been resized to a smaller amount of objects
+	int32 NumberOfObjectsToShrink = 0;
+
+	bool bIsWarmedUp = false;
+
+	int32 PoolIndex = INDEX_NONE;
+
+	EPoolDeactivationStrategy DeactivationStrategy = EPoolDeactivationStrategy::FULL_DISABLE;
+
+	FVector ParkingLocation;
+
+	float ParkingSpacing = 0.f;
+
+	// The number of parking spots along every axis. The grid stays inside the world bounds, its spots are shared if there are more slots
+	FIntVector ParkingGridSize = FIntVector(1, 1, 1);
+
+	// The offset between two parking spots along every axis, it points away from the world origin
+	FVector ParkingGridStep = FVector::ZeroVector;
+
+	static constexpr int32 MaxParkingSpotsPerAxis = 1024;
+
+	// True if the active objects are updated by the tick of the pool instead of their own ticks
+	bool bBatchedUpdate = false;
+
+	// The active objects of a pool with a batched update. The hot data is stored as a dense struct of arrays, all arrays are indexed alike.
+	// Objects which have been destroyed by the gameplay while they were active are removed by the next update
+	TArray<int32> BatchedSlots;
+	UPROPERTY()
+		TArray<UObject*> BatchedObjects;
+	TArray<IPoolableInterface*> BatchedInterfaces;
+	TArray<FVector> BatchedLocations;
+	TArray<FVector> BatchedVelocities;
+	TArray<float> BatchedLifeSpans;
+
+	void AddToBatchedUpdate(UObject* Object);
+
+	void RemoveFromBatchedUpdate(UObject* Object);
+
+	// Swap the last batched object into the index and shrink all arrays
+	void RemoveBatchedIndex(int32 BatchIndex);
+
+	// Move all active objects by their velocity, call their native update and return the expired ones
+	void UpdateBatchedObjects(float DeltaSeconds);
+
+	// Renders the lightweight instances of the pool, nullptr if the pool entry doesn't have an instanced mesh
+	UPROPERTY()
+		UInstancedStaticMeshComponent* InstancedMeshComponent = nullptr;
+
+	FPoolInstanceSet Instances;
+
+	// The actors which represent promoted instances, both maps are kept in sync
+	TMap<AActor*, FPoolInstanceHandle> PromotedActorsToInstances;
+	TMap<int32, AActor*> InstancesToPromotedActors;
+
+	// Reused by every flush
+	TArray<int32> DirtyInstances;
+
+	// Create the instanced mesh component and the hidden instances of the pool entry
+	void CreateInstancedMesh(const FPoolEntry& PoolEntry);
+
+	// Forget the instance of a promoted actor, returns an invalid handle if the actor isn't promoted
+	FPoolInstanceHandle UnbindPromotedActor(AActor* Actor);
+
+	// The new actors are spawned from this template, it is never spawned itself
+	UPROPERTY()
+		AActor* TemplateActor = nullptr;
+
+	// Return the object of the used slot and take it again. A promoted actor leaves its instance behind where it has been
+	UObject* RecycleSlot(int32 SlotIndex);
+
+	// Create the template with the deactivated state of the pool
+	void CreateTemplateActor(UClass* Class);
+
+	// Move the actor to its parking location and put its bodies to sleep
+	void ParkActor(AActor* Actor);
+
+	// Fit the parking grid between the parking location and the world bounds
+	void InitializeParkingGrid();
+
+	// Spawns a new actor or creates a new object of the pool class, without adding it to the pool
+	UObject* CreateObject();
+
+	// Give the object a slot and add it to the used list without making it available
+	int32 RegisterObject(UObject* Object);
+
+	// Take the object of the available slot and count it as a hit
+	UObject* AcquireSlot(int32 SlotIndex);
+
+	void UpdatePeakInUse();
+
+	FPoolStats Stats;
+
+#if CSV_PROFILER
+	FName CsvStatNameInUse;
+	FName CsvStatNameAvailable;
+	FName CsvStatNameMisses;
+#endif
+
+	// Destroy the object of the available slot and mark the slot as dead
+	void DestroySlot(int32 SlotIndex);
+
+	// Unregister the free or used slot and mark it as dead, e.g. because the gameplay has destroyed its object. Its stale handles and ids stop resolving
+	void RetireSlot(int32 SlotIndex);
+
+	// Retire the slots of destroyed objects at the front of the free list, returns the first free slot with a valid object
+	int32 GetFirstValidFreeSlot();
+
+	// Returns false if the sizing policy or the memory budget doesn't allow any more objects
+	bool CanGrow() const {
+		return bIsGrowthAllowed
+			&& (SizingPolicy.MaxObjects <= 0 || GetNumberOfObjects() < SizingPolicy.MaxObjects)
+			&& (MemoryBudgetBytes <= 0 || GetMemoryBytes() + BytesPerObject <= MemoryBudgetBytes);
+	}
+
+	int64 BytesPerObject = 0;
+
+	// The memory budget of the pool entry in bytes (0 = unlimited)
+	int64 MemoryBudgetBytes = 0;
+
+	bool bIsGrowthAllowed = true;
+
+	// The problems with the ids of the pool are only reported once
+	mutable bool bHasReportedIdOverflow = false;
+	mutable bool bHasReportedUnstableIds = false;
+
+	// Sum up the size of the object and its components, the assets which are shared with other objects aren't counted
+	static int64 MeasureObjectBytes(UObject* Object);
+
+	// Don't warm up more objects than the memory budget allows
+	void LimitToMemoryBudget();
+
+	// Measure the first object of the pool, the class default object doesn't own the components of the construction scripts
+	void MeasureFirstObject(UObject* Object);
+
 	void RestoreActorSettings(AActor* Actor);
 
+	// Returns the slot of the object or INDEX_NONE if the object isn't a part of this pool
+	int32 FindSlot(UObject* Object) const;
+
+	// Move the used slot to the front of the free list
+	void PushFreeSlot(int32 SlotIndex);
+
+	void ClearDeferredActivation(int32 SlotIndex);
+
+	// Move the available slot to the back of the used list and return its object
+	UObject* TakeSlot(int32 SlotIndex);
+
+	// Link the slot to the front or back of the list
+	void LinkSlot(int32 SlotIndex, int32& FirstSlot, int32& LastSlot, bool bAddToFront);
+
+	void UnlinkSlot(int32 SlotIndex, int32& FirstSlot, int32& LastSlot);
+
 };
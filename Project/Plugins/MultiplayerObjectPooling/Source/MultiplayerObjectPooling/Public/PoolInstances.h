@@ -0,0 +1,140 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PoolInstances.generated.h"
+
+/**
+ * Identifies a lightweight instance of a pool, it stays valid while the instance is promoted to an actor.
+ * The generation increases every time the instance is freed, so a handle of a freed instance doesn't resolve anymore.
+ */
+USTRUCT(BlueprintType, Category = "Object Pool")
+struct FPoolInstanceHandle {
+	GENERATED_BODY()
+
+public:
+
+	FPoolInstanceHandle()
+		: PoolIndex(INDEX_NONE)
+		, InstanceIndex(INDEX_NONE)
+		, Generation(0)
+	{}
+
+	FPoolInstanceHandle(int32 InPoolIndex, int32 InInstanceIndex, int32 InGeneration)
+		: PoolIndex(InPoolIndex)
+		, InstanceIndex(InInstanceIndex)
+		, Generation(InGeneration)
+	{}
+
+	bool IsValid() const { return InstanceIndex != INDEX_NONE; }
+
+	bool operator==(const FPoolInstanceHandle& Other) const { return PoolIndex == Other.PoolIndex && InstanceIndex == Other.InstanceIndex && Generation == Other.Generation; }
+	bool operator!=(const FPoolInstanceHandle& Other) const { return !(*this == Other); }
+
+	// The index of the pool inside the pool manager
+	UPROPERTY()
+		int32 PoolIndex;
+
+	// The index of the instance inside the instanced static mesh of the pool
+	UPROPERTY()
+		int32 InstanceIndex;
+
+	UPROPERTY()
+		int32 Generation;
+};
+
+/**
+ * The bookkeeping of the lightweight instances of a pool. It only stores a transform and a small payload per instance
+ * and doesn't know the instanced static mesh component which renders them, so it works without a world.
+ * Freed and promoted instances are kept and hidden with a zero scale, the render instances are never removed
+ * and their indices never change. Only the instances whose render transform has changed have to be sent to the component.
+ */
+class MULTIPLAYEROBJECTPOOLING_API FPoolInstanceSet
+{
+public:
+
+	enum class EState : uint8 {
+		// Hidden and ready to be reused
+		Free,
+		// Rendered by the instanced static mesh
+		Active,
+		// Hidden while an actor of the pool represents the instance
+		Promoted
+	};
+
+	// Remove all instances, the handles of the pool contain the pool index
+	void Initialize(int32 InPoolIndex);
+
+	// Add free instances until the set contains the given number of instances
+	void Reserve(int32 NumberOfInstances);
+
+	// Take a free instance or add a new one. The free instance which has been freed last is reused first
+	FPoolInstanceHandle Add(const FTransform& Transform, const FVector4& Payload = FVector4(0.f, 0.f, 0.f, 0.f));
+
+	// Free an active or promoted instance, returns false if the handle is stale
+	bool Remove(FPoolInstanceHandle Handle);
+
+	// Hide an active instance while an actor represents it, the handle and the payload stay valid
+	bool Promote(FPoolInstanceHandle Handle);
+
+	// Show a promoted instance again at the transform of its actor
+	bool Demote(FPoolInstanceHandle Handle, const FTransform& Transform);
+
+	// Returns Free for stale handles
+	EState GetState(FPoolInstanceHandle Handle) const;
+
+	bool SetTransform(FPoolInstanceHandle Handle, const FTransform& Transform);
+
+	bool GetTransform(FPoolInstanceHandle Handle, FTransform& OutTransform) const;
+
+	// Returns nullptr for stale handles. The payload isn't rendered, so changing it doesn't dirty the instance
+	FVector4* GetPayload(FPoolInstanceHandle Handle);
+
+	// The number of instances including the free ones, the instanced static mesh has to contain the same number of instances
+	int32 Num() const { return Transforms.Num(); }
+
+	int32 GetNumberOfActiveInstances() const { return NumberOfActiveInstances; }
+
+	int32 GetNumberOfPromotedInstances() const { return NumberOfPromotedInstances; }
+
+	int32 GetNumberOfFreeInstances() const { return FreeInstances.Num(); }
+
+	// The transform which has to be rendered, free and promoted instances are hidden with a zero scale
+	FTransform GetRenderTransform(int32 InstanceIndex) const;
+
+	// Move the indices of the instances whose render transform has changed since the last call to the array
+	void ConsumeDirtyInstances(TArray<int32>& OutInstanceIndices);
+
+	// The memory of the instances in bytes
+	int64 GetAllocatedBytes() const;
+
+private:
+
+	int32 PoolIndex = INDEX_NONE;
+
+	// All arrays are indexed by the instance index
+	TArray<FTransform> Transforms;
+	TArray<FVector4> Payloads;
+	TArray<int32> Generations;
+	TArray<EState> States;
+
+	// Used as a stack, the instance which has been freed last is reused first
+	TArray<int32> FreeInstances;
+
+	// Every instance is only added once to the dirty instances
+	TBitArray<> DirtyFlags;
+	TArray<int32> DirtyInstances;
+
+	int32 NumberOfActiveInstances = 0;
+
+	int32 NumberOfPromotedInstances = 0;
+
+	// Returns INDEX_NONE if the handle doesn't belong to this set or its instance has been freed since
+	int32 FindInstance(FPoolInstanceHandle Handle) const;
+
+	void MarkDirty(int32 InstanceIndex);
+
+	// Add a free instance and return its index
+	int32 AddFreeInstance();
+};
@@ -6,6 +6,8 @@
 #include "GameFramework/Actor.h"
 #include "PoolHolder.h"
 #include "Runtime/Engine/Classes/Engine/DataTable.h"
+#include "Engine/StreamableManager.h"
+#include "Containers/Queue.h"
 #include "PoolManager.generated.h"
 
 
@@ -19,7 +21,8 @@ UENUM(BlueprintType)
 enum class EHandleEmptyPool : uint8 {
 	IGNORE				UMETA(DisplayName = "Ignore", ToolTip = "Ignore that no actor is available in the pool. No actor will be returned!"),
 	CREATE				UMETA(DisplayName = "Create", ToolTip = "Create a new actor and return it."),
-	CREATE_AND_ADD		UMETA(DisplayName = "CreateAndAdd", ToolTip = "Create and add a new actor to the pool, this actor will be returned.")
+	CREATE_AND_ADD		UMETA(DisplayName = "CreateAndAdd", ToolTip = "Create and add a new actor to the pool, this actor will be returned."),
+	RECYCLE_OLDEST		UMETA(DisplayName = "RecycleOldest", ToolTip = "Return the actor which has been in use for the longest time to the pool and hand it out again. The pool never grows.")
 };
 
 UENUM(BlueprintType)
@@ -50,38 +53,108 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ToolTip = "Set an specific actor name to spawn from the pool"))
 		FString SpecificActor = "";
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ToolTip = "Set an specific object id to spawn from the pool (see GetObjectId). It is used instead of the name if it is valid"))
+		FPoolObjectId SpecificId;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ToolTip = "What has to happen when the specified actor can't be found?"))
 		EHandleNoSpecificFound HandleNoSpecificFound = EHandleNoSpecificFound::NEXT_FREE;
 };
 
+class APoolManager;
+
+// Identifies a pool of the pool manager. Resolve it once with GetPoolHandle and cache it to skip the class lookup
+USTRUCT(BlueprintType, Category = "Object Pool")
+struct FPoolHandle {
+	GENERATED_BODY()
+
+public:
+
+	FPoolHandle()
+		: Index(INDEX_NONE)
+		, Generation(INDEX_NONE)
+	{}
+
+	FPoolHandle(APoolManager* InPoolManager, int32 InIndex, int32 InGeneration)
+		: PoolManager(InPoolManager)
+		, Index(InIndex)
+		, Generation(InGeneration)
+	{}
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	// The pool manager of the world which owns the pool
+	UPROPERTY()
+		TWeakObjectPtr<APoolManager> PoolManager;
+
+	// The index of the pool inside the pool manager
+	UPROPERTY()
+		int32 Index;
+
+	// Handles become stale when the pool manager rebuilds its pools
+	UPROPERTY()
+		int32 Generation;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FInitializedPoolManager);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPoolWarmUpProgress, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPoolReady, UClass*, Class);
 
-UCLASS(MinimalAPI)
-class APoolManager : public AActor
+UCLASS()
+class MULTIPLAYEROBJECTPOOLING_API APoolManager : public AActor
 {
 	GENERATED_BODY()
 	
 public:
 
-	// Instance for this singleton
-	static APoolManager* Instance;
-
 	UPROPERTY(BlueprintAssignable)
 		FInitializedPoolManager OnInitialized;
 
-	TMap<FString, APoolHolder*> ClassNamesToPools = TMap<FString, APoolHolder*>();
+	// Called during a time sliced warm up with the ratio of created objects to all desired objects
+	UPROPERTY(BlueprintAssignable)
+		FPoolWarmUpProgress OnWarmUpProgress;
+
+	// Called every time a pool contains all of its desired objects
+	UPROPERTY(BlueprintAssignable)
+		FPoolReady OnPoolReady;
+
+	UPROPERTY()
+		TMap<UClass*, APoolHolder*> ClassesToPools;
 
 	// Sets default values for this actor's properties
 	APoolManager();
 
-	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Get the singleton instance of the pool manager"))
-		static APoolManager* GetPoolManager();
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the pool manager of the world"))
+		static APoolManager* GetPoolManager(const UObject* WorldContextObject);
+
+	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get a single object from the pool", DeterminesOutputType = "Class", Keywords = "Get Pool"))
+		static UObject* GetFromPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch);
+
+	UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the handle of the pool for the class. Cache it and use it to get objects without looking up the pool again"))
+		static FPoolHandle GetPoolHandle(const UObject* WorldContextObject, TSubclassOf<UObject> Class);
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Get a single object from the pool of the handle", Keywords = "Get Pool Handle"))
+		static UObject* GetFromPoolByHandle(FPoolHandle Handle, FSpawnParameter SpawnParameter);
 
-	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Get a single object from the pool", DeterminesOutputType = "Class", Keywords = "Get Pool"))
-		static UObject* GetFromPool(TSubclassOf<UObject> Class, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch);
+	// Get a single object from the pool of the handle, without any class lookup
+	template<class T>
+	static T* Acquire(FPoolHandle Handle, const FSpawnParameter& SpawnParameter = FSpawnParameter()) {
+		return Cast<T>(AcquireFromPoolHolder(ResolvePoolHandle(Handle), SpawnParameter));
+	}
 
-	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (AdvancedDisplay = "PoolOwner,PoolInstigator,SpawnParameter,SpecificSearch", ToolTip = "Use this function like SpawnActor, but instead of creating a new actor it will take an unused one from the pool", DeterminesOutputType = "Class", ExpandEnumAsExecs = "Branch", Keywords = "Spawn Pool Get"))
-		static AActor* SpawnActorFromPool(TSubclassOf<AActor> Class, FTransform SpawnTransform, UPARAM(DisplayName = "Owner") AActor* PoolOwner, UPARAM(DisplayName = "Instigator") APawn* PoolInstigator, EBranch& Branch, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch);
+	// Returns the pool of the handle or nullptr if the handle is stale
+	static FORCEINLINE APoolHolder* ResolvePoolHandle(FPoolHandle Handle) {
+		APoolManager* PoolManager = Handle.PoolManager.Get();
+		if (PoolManager == nullptr || Handle.Generation != PoolManager->PoolGeneration) return nullptr;
+
+		APoolHolder* PoolHolder = PoolManager->Pools.IsValidIndex(Handle.Index) ? PoolManager->Pools[Handle.Index] : nullptr;
+		return PoolHolder != nullptr ? PoolHolder : PoolManager->ResolvePendingPool(Handle.Index);
+	}
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", AdvancedDisplay = "PoolOwner,PoolInstigator,SpawnParameter,SpecificSearch", ToolTip = "Use this function like SpawnActor, but instead of creating a new actor it will take an unused one from the pool", DeterminesOutputType = "Class", ExpandEnumAsExecs = "Branch", Keywords = "Spawn Pool Get"))
+		static AActor* SpawnActorFromPool(const UObject* WorldContextObject, TSubclassOf<AActor> Class, FTransform SpawnTransform, UPARAM(DisplayName = "Owner") AActor* PoolOwner, UPARAM(DisplayName = "Instigator") APawn* PoolInstigator, EBranch& Branch, FSpawnParameter SpawnParameter, FSpecificSearch SpecificSearch);
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", AdvancedDisplay = "PoolOwner,PoolInstigator,SpawnParameter", ToolTip = "Spawn one actor from the pool for every transform. The pool is looked up once and grows in one step if it doesn't contain enough actors", ExpandEnumAsExecs = "Branch", Keywords = "Spawn Pool Get Multiple Batch"))
+		static void SpawnActorsFromPool(const UObject* WorldContextObject, TSubclassOf<AActor> Class, const TArray<FTransform>& SpawnTransforms, UPARAM(DisplayName = "Owner") AActor* PoolOwner, UPARAM(DisplayName = "Instigator") APawn* PoolInstigator, TArray<AActor*>& OutActors, EBranch& Branch, FSpawnParameter SpawnParameter);
 
 	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Set the actor active (reconstruct default values, visibility, tick)", DisplayName = "SetActive"))
 		static void SetPoolObjectActive(UObject* Object, bool bSetActive = true);
@@ -89,64 +162,321 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Object Pool|Multiplayer", Meta = (ToolTip = "Get the name of the object for the function 'GetSpecificFromPool'", DefaultToSelf = "Object", Keywords = "Object Pool", DisplayName = "GetName"))
 		static FString GetObjectName(UObject* Object);
 
+	UFUNCTION(BlueprintPure, Category = "Object Pool|Multiplayer", Meta = (ToolTip = "Get the compact id of the pooled object. It is the same on all peers if the pools have a fixed size and the objects are acquired in the same order. Send it instead of the name", DefaultToSelf = "Object", Keywords = "Object Pool Id Network"))
+		static FPoolObjectId GetObjectId(UObject* Object);
+
+	UFUNCTION(BlueprintPure, Category = "Object Pool|Multiplayer", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the pooled object of the id. Returns nothing if the object has been returned to the pool since the id was taken", Keywords = "Object Pool Id Network Resolve"))
+		static UObject* GetObjectById(const UObject* WorldContextObject, FPoolObjectId ObjectId);
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool|Multiplayer", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the specific object of the id from its pool", Keywords = "Object Pool Id Network Specific"))
+		static UObject* GetSpecificFromPool(const UObject* WorldContextObject, FPoolObjectId ObjectId, FSpawnParameter SpawnParameter, EHandleNoSpecificFound HandleNoSpecificFound = EHandleNoSpecificFound::IGNORE);
+
+	// Get the specific object of the id from its pool, without any class lookup
+	template<class T>
+	static T* AcquireSpecific(const UObject* WorldContextObject, FPoolObjectId ObjectId, const FSpawnParameter& SpawnParameter = FSpawnParameter(), EHandleNoSpecificFound HandleNoSpecificFound = EHandleNoSpecificFound::IGNORE) {
+		return Cast<T>(GetSpecificFromPool(WorldContextObject, ObjectId, SpawnParameter, HandleNoSpecificFound));
+	}
+
 	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (DefaultToSelf = "Object", ToolTip = "Put an used object back to the pool", Keywords = "Return Back Pool Destroy", DisplayName = "Destroy"))
 		static void ReturnToPool(UObject* Object);
 
+	/*
+	* Put an used object back to the pool at the end of the frame. This function can be called from any thread.
+	* Don't use the object after it has been queued, it can be handed out again after the queue has been processed
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (DefaultToSelf = "Object", ToolTip = "Put an used object back to the pool at the end of the frame", Keywords = "Return Back Pool Destroy Deferred Queue", DisplayName = "Destroy (Deferred)"))
+		static void ReturnToPoolDeferred(UObject* Object);
+
 	UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (ToolTip = "Returns true if the object is NOT a part of the available object pool", Keywords = "Active Object Pool", DisplayName = "IsActive?"))
 		static bool IsObjectActive(UObject* Object);
 
-	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Clear a specific pool", Keywords = "Empty Clear Pool Destroy"))
-		static void EmptyObjectPool(TSubclassOf<UObject> Class);
+	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Clear a specific pool", Keywords = "Empty Clear Pool Destroy"))
+		static void EmptyObjectPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class);
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Start loading the class of a pool which is defined with a soft class. The pool is created as soon as the class is loaded", Keywords = "Load Async Stream Pool"))
+		static void RequestPoolLoad(const UObject* WorldContextObject, TSoftClassPtr<UObject> Class);
+
+	UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the amount of used objects of the pool"))
+		static int32 GetNumberOfUsedObjects(const UObject* WorldContextObject, TSubclassOf<UObject> Class);
+
+	UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the amount of unused objects of the pool"))
+		static int32 GetNumberOfAvailableObjects(const UObject* WorldContextObject, TSubclassOf<UObject> Class);
+
+	/*
+	* Create an additional pool at runtime, the pool is filled right away
+	* @return The handle of the new pool or of the existing pool for the class
+	*/
+	FPoolHandle AddObjectPool(const FPoolEntry& PoolEntry);
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Replace the data table which defines the pools, e.g. for another game mode. The pools of the classes which are a part of both tables keep their objects"))
+		void SetDataTable(UDataTable* NewDataTable);
+
+	UFUNCTION(BlueprintPure, Category = "Object Pool")
+		UDataTable* GetDataTable() const { return DataTable; }
+
+	/*
+	* Print the counters of all pools as a table
+	* @param SortBy	The column to sort by: acquires, misses, peak, creations, memory or time
+	*/
+	void DumpStats(FOutputDevice& Ar, const FString& SortBy) const;
+
+	//UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Returns true if the object pool holds objects of the given class", Keywords = "Contains Object Pool"))
+		static bool ContainsClass(const UObject* WorldContextObject, TSubclassOf<UObject> Class);
 
-	//UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (ToolTip = "Get the amount of used objects of the pool"))
-		static int32 GetNumberOfUsedObjects(TSubclassOf<UObject> Class);
+	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get a variable number of objects from the pool", DeterminesOutputType = "Class", Keywords = "X Amount Number Quantity Pool"))
+		static TArray<UObject*> GetXFromPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class, int32 Quantity = 10);
 
-	//UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (ToolTip = "Get the amount of unused objects of the pool"))
-		static int32 GetNumberOfAvailableObjects(TSubclassOf<UObject> Class);
+	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get all unused objects from the pool", DeterminesOutputType = "Class", Keywords = "All Pool"))
+		static TArray<UObject*> GetAllFromPool(const UObject* WorldContextObject, TSubclassOf<UObject> Class);
 
-	//UFUNCTION(BlueprintPure, Category = "Object Pool", Meta = (ToolTip = "Returns true if the object pool holds objects of the given class", Keywords = "Contains Object Pool"))
-		static bool ContainsClass(TSubclassOf<UObject> Class);
+	UFUNCTION(BlueprintCallable, Category = "Object Pool|Instances", Meta = (WorldContext = "WorldContextObject", ToolTip = "Add a lightweight instance to the instanced mesh of the pool. It doesn't have an actor until it gets promoted", Keywords = "Spawn Pool Instance Virtual Lightweight"))
+		static FPoolInstanceHandle SpawnInstanceFromPool(const UObject* WorldContextObject, TSubclassOf<AActor> Class, FTransform Transform);
 
-	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Get a variable number of objects from the pool", DeterminesOutputType = "Class", Keywords = "X Amount Number Quantity Pool"))
-		static TArray<UObject*> GetXFromPool(TSubclassOf<UObject> Class, int32 Quantity = 10);
+	UFUNCTION(BlueprintCallable, Category = "Object Pool|Instances", Meta = (WorldContext = "WorldContextObject", ToolTip = "Free the instance. The actor of a promoted instance is returned to the pool", Keywords = "Return Back Pool Destroy Instance"))
+		static bool ReturnInstanceToPool(const UObject* WorldContextObject, FPoolInstanceHandle Handle);
 
-	//UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "Get all unused objects from the pool", DeterminesOutputType = "Class", Keywords = "All Pool"))
-		static TArray<UObject*> GetAllFromPool(TSubclassOf<UObject> Class);
+	UFUNCTION(BlueprintCallable, Category = "Object Pool|Instances", Meta = (WorldContext = "WorldContextObject", ToolTip = "Move the instance. A promoted instance only remembers the transform, it is replaced by the transform of its actor on demotion", Keywords = "Move Instance"))
+		static bool SetInstanceTransform(const UObject* WorldContextObject, FPoolInstanceHandle Handle, FTransform Transform);
 
-	/// Spawns an Actor from Pool, manually running its Construction Scripts if a full reset is needed.
+	UFUNCTION(BlueprintPure, Category = "Object Pool|Instances", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the transform of the instance, returns false if the instance has been freed"))
+		static bool GetInstanceTransform(const UObject* WorldContextObject, FPoolInstanceHandle Handle, FTransform& Transform);
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool|Instances", Meta = (WorldContext = "WorldContextObject", ToolTip = "Let an actor of the pool represent the instance while the gameplay needs it, e.g. for collision or interaction. The instance is hidden until the actor gets demoted", Keywords = "Promote Instance Actor"))
+		static AActor* PromoteInstance(const UObject* WorldContextObject, FPoolInstanceHandle Handle, FSpawnParameter SpawnParameter);
+
+	UFUNCTION(BlueprintCallable, Category = "Object Pool|Instances", Meta = (DefaultToSelf = "Actor", ToolTip = "Return the actor to the pool and show its instance at the transform of the actor again. An actor which hasn't been promoted gets a new instance", Keywords = "Demote Instance Actor"))
+		static FPoolInstanceHandle DemoteToInstance(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Object Pool|Instances", Meta = (WorldContext = "WorldContextObject", ToolTip = "Get the actor which represents the instance, returns nothing if the instance isn't promoted"))
+		static AActor* GetPromotedActor(const UObject* WorldContextObject, FPoolInstanceHandle Handle);
+
+	// The payload of the instance, nullptr if the instance has been freed
+	static FVector4* GetInstancePayload(const UObject* WorldContextObject, FPoolInstanceHandle Handle);
+
+	/// Takes a deactivated Actor with restored default values from the Pool to configure it before FinishDeferredSpawnFromPool activates it. Reconstruct also calls the native OnConstruction at the spawn transform, components which it adds pile up with every reuse. The blueprint construction script isn't run again.
 	UFUNCTION(Category = "Object Pool", BlueprintCallable, Meta = (WorldContext = "WorldContextObject", UnsafeDuringActorConstruction = "true", BlueprintInternalUseOnly = "true"))
 		static AActor* BeginDeferredSpawnFromPool(const UObject* WorldContextObject, UClass* Class, const FTransform &SpawnTransform, ESpawnActorCollisionHandlingMethod CollisionHandlingOverride, const bool Reconstruct, bool &SpawnSuccessful);
 	//static AActor* BeginDeferredSpawnFromPool(const UObject* WorldContextObject, UClass* Class, const FPoolSpawnOptions &SpawnOptions, const FTransform &SpawnTransform, ESpawnActorCollisionHandlingMethod CollisionHandlingOverride, AActor* Owner, const bool Reconstruct, bool &SpawnSuccessful);
 
-	/// Finishes Deferred Spawning an Actor from Pool.
+	/// Finishes Deferred Spawning an Actor from Pool, the values which were set since BeginDeferredSpawnFromPool are kept. An Actor which is already active isn't activated again.
 	UFUNCTION(Category = "Object Pool", BlueprintCallable, Meta = (WorldContext = "WorldContextObject", UnsafeDuringActorConstruction = "true", BlueprintInternalUseOnly = "true"))
 		static AActor* FinishDeferredSpawnFromPool(AActor* Actor, const FTransform &SpawnTransform);
 
 
 protected:
-	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "This will initialize all the pools defined by DesiredPools"))
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", Meta = (ToolTip = "This will initialize all the pools defined by the data table. Existing pools are only changed where they differ from the data table, unchanged pools keep their objects"))
 		void InitializePools();
 
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Warms up the pools, processes the deferred returns and adapts the pool sizes
+	virtual void Tick(float DeltaSeconds) override;
 	
 private:
 
 	UPROPERTY(EditInstanceOnly, Meta = (ToolTip = "The desired pools. The PoolManager will create these pools on BeginPlay! (Create a data table with the struct PoolEntry)"))
 		UDataTable* DataTable;
 
+	UPROPERTY(EditInstanceOnly, Meta = (ToolTip = "Spread the creation of the pool objects over multiple frames instead of creating all of them on BeginPlay"))
+		bool bTimeSlicedWarmUp = false;
+
+	UPROPERTY(EditInstanceOnly, Meta = (ToolTip = "The time in milliseconds which can be spent per frame to warm up the pools", EditCondition = "bTimeSlicedWarmUp", ClampMin = "0.1"))
+		float WarmUpBudgetMs = 2.f;
+
+	UPROPERTY(EditInstanceOnly, Meta = (ToolTip = "The time in milliseconds which can be spent per frame to grow and shrink the pools with an adaptive size", ClampMin = "0.1"))
+		float SizingBudgetMs = 1.f;
+
+	UPROPERTY(EditInstanceOnly, Meta = (ToolTip = "The time in milliseconds which can be spent per frame to destroy the pools of unloaded streaming levels", ClampMin = "0.1"))
+		float DrainBudgetMs = 1.f;
+
+	UPROPERTY(EditInstanceOnly, Meta = (ToolTip = "The memory in megabytes all pools of this pool manager may pin together. Above it the pools stop growing and the available objects of the pools with the lowest warm up priority are destroyed first (0 = unlimited)", ClampMin = "0"))
+		int32 MemoryBudgetMB = 0;
+
+	UPROPERTY(EditInstanceOnly, Meta = (ToolTip = "The time in milliseconds which can be spent per frame to trim the pools to their memory budgets", ClampMin = "0.1"))
+		float TrimBudgetMs = 1.f;
+
+	// True while the pools are not allowed to grow because they exceed the memory budget
+	bool bIsOverMemoryBudget = false;
+
 	bool bIsReady = false;
 
+	// The pools which still have to be filled, ordered by their warm up priority
+	UPROPERTY()
+		TArray<APoolHolder*> PoolsToWarmUp;
+
+	/*
+	* The pools of unloaded streaming levels and the removed pools, their objects are destroyed time sliced. The objects live in the persistent level,
+	* so a pool is only destroyed after all of its used objects have been returned. A removed pool isn't a part of the pools anymore
+	*/
+	UPROPERTY()
+		TArray<APoolHolder*> PoolsToDrain;
+
+	// The pools which only exist while their streaming level is loaded
+	struct FStreamingLevelPools {
+		// The package name of the level inside this world (with the PIE prefix)
+		FName PackageName;
+		TArray<int32> PoolIndices;
+		bool bIsLoaded = false;
+	};
+
+	TArray<FStreamingLevelPools> StreamingLevelPools;
+
+	// The entries of all pools, indexed like the pools
+	UPROPERTY()
+		TArray<FPoolEntry> PoolEntries;
+
+	// Marks the pools which have been defined by the data table, indexed like the pools. The pools of AddObjectPool are left alone by InitializePools
+	TBitArray<> DataTablePools;
+
+	// Set when the data table has been edited while playing in the editor, the pools are updated with the next tick
+	bool bIsDataTableDirty = false;
+
+	FDelegateHandle DataTableChangedHandle;
+
+	// Listen to the edits of the data table, only inside the editor
+	void BindDataTable();
+
+	void UnbindDataTable();
+
+	void OnDataTableChanged();
+
+	// The pools of the data table are matched by this path
+	static FSoftObjectPath GetPoolClassPath(const FPoolEntry& PoolEntry);
+
+	/*
+	* Apply a changed entry of the data table to its existing pool. Changed sizes are applied in place,
+	* every other change rebuilds the pool at the same index
+	*/
+	void UpdatePool(int32 PoolIndex, const FPoolEntry& PoolEntry);
+
+	// Drain the pool and cancel the loading of its class, its used objects are destroyed after they have been returned. The index stays reserved to keep the other handles valid
+	void RemovePool(int32 PoolIndex);
+
+	// Order the pools which still have to be filled by their current warm up priority, called after a priority has changed
+	void SortPoolsToWarmUp();
+
+	// The last slot generations of the pools which have been removed or released, a pool which is created at the same index continues them
+	TMap<int32, TArray<uint8>> RetiredSlotGenerations;
+
+	void RetireSlotGenerations(APoolHolder* PoolHolder);
+
+	// The pool which holds the object, a removed pool which still drains comes first
+	APoolHolder* GetPoolOfObject(UObject* Object);
+
+	// Keeps the soft classes of the pools loaded, indexed like the pools
+	TArray<TSharedPtr<FStreamableHandle>> PoolStreamingHandles;
+
+	// Maps the soft classes to the pools which are still waiting for their class
+	TMap<FSoftObjectPath, int32> PendingPools;
+
+	FStreamableManager StreamableManager;
+
+	// True after OnInitialized has been broadcasted
+	bool bIsInitialized = false;
+
+	// The pool manager of every world, every world has its own independent pools
+	static TMap<const UWorld*, APoolManager*> WorldsToPoolManagers;
+
+	/*
+	* Objects which have been returned from any thread. The queue isn't seen by the garbage collector, objects which have been
+	* collected before the queue is processed are skipped. The queue is shared by all worlds,
+	* the first pool manager which ticks in a frame hands the objects to the pool manager of their world
+	*/
+	static TQueue<TWeakObjectPtr<UObject>, EQueueMode::Mpsc> DeferredReturns;
+
+	// The spawn transforms of deferred spawned actors which have been moved by the collision handling. Entries of spawns which are never finished are removed by the tick
+	TMap<TWeakObjectPtr<AActor>, FTransform> DeferredSpawnTransforms;
+
+	// Reused every frame to group the deferred returns by their pool
+	TArray<TPair<APoolHolder*, UObject*>> DeferredReturnBatch;
+
+	TArray<UObject*> DeferredReturnGroup;
+
+	// All pools indexed by their handle. Emptied pools leave a nullptr behind to keep the other handles valid
+	UPROPERTY()
+		TArray<APoolHolder*> Pools;
+
+	// Increased every time all pools are destroyed
+	int32 PoolGeneration = 0;
+
 	void DestroyAllPools();
 
-	void InitializeObjectPool(FPoolEntry PoolEntry);
+	// Reserve a pool for the entry, the pool holder is created by InitializeObjectPool
+	int32 AddPoolEntry(const FPoolEntry& PoolEntry);
+
+	APoolHolder* InitializeObjectPool(int32 PoolIndex, UClass* Class);
+
+	// Create the pool holder of the entry and queue its warm up, or start loading its soft class
+	void CreatePool(int32 PoolIndex);
+
+	// Register the pool of a level scoped entry, it is created when its level starts loading
+	void AddStreamingLevelPool(int32 PoolIndex);
+
+	// Create or drain the pools of the streaming levels which started loading or got unloaded, called once per frame
+	void UpdateStreamingLevelPools();
+
+	// Forget the adjusted transforms of deferred spawns whose actor has been destroyed, returned or activated without finishing the spawn
+	void RemoveUnfinishedDeferredSpawns();
+
+	void LoadStreamingLevelPools(FStreamingLevelPools& LevelPools);
+
+	void UnloadStreamingLevelPools(FStreamingLevelPools& LevelPools);
+
+	// Spend at most the drain budget to destroy the available objects of the drained pools, the empty pools are destroyed
+	void DrainPools();
+
+	// Start loading the soft class of the pool asynchronously. The pool is created right away if its class is still loaded
+	void LoadPoolClass(int32 PoolIndex);
+
+	/*
+	* Called when a handle refers to a pool which hasn't been created yet. A pending pool is created if its class is loaded,
+	* otherwise its class starts loading
+	* @return The created pool or nullptr
+	*/
+	APoolHolder* ResolvePendingPool(int32 PoolIndex);
+
+	void OnPoolClassLoaded(int32 PoolIndex, int32 Generation);
+
+	// Create the pool holder of a pending pool whose class is loaded and start its warm up
+	APoolHolder* InitializePendingPool(int32 PoolIndex, UClass* Class);
+
+	// Return the objects whose life span has run out to their pools, called once per frame
+	void ReturnExpiredObjects();
+
+	// Return all queued objects to their pools, called once per frame
+	void ProcessDeferredReturns();
+
+	// Let the pools with an adaptive size grow or shrink, called once per frame
+	void UpdatePoolSizes(float DeltaSeconds);
+
+	// Called when a pool gets emptied, soft class pools can be loaded again afterwards
+	void ReleasePool(int32 PoolIndex);
+
+	// Destroy available objects until the pools fit into their resized entries and into their own and the global memory budget, called once per frame.
+	// Pools which are still warming up are trimmed as well, their warm up stops at the budget
+	void TrimPools();
+
+	// Spend at most the warm up budget to fill the remaining pools
+	void WarmUpPools();
+
+	// The bytes which are left of the global memory budget, the maximum if there is no budget
+	int64 GetRemainingMemoryBytes() const;
 
 	/*
 	* Return false if the PoolManager doesn't contain the specific poolholder
 	*/
 	bool GetPoolHolder(TSubclassOf<UObject> Class, APoolHolder*& PoolHolder);
 
-	static bool IsPoolManagerReady();
+	static UObject* AcquireFromPoolHolder(APoolHolder* PoolHolder, const FSpawnParameter& SpawnParameter, const FSpecificSearch* SpecificSearch = nullptr);
+
+	// Returns nullptr if the pool of the handle doesn't exist or doesn't use instances
+	static APoolHolder* GetInstancePool(const UObject* WorldContextObject, FPoolInstanceHandle Handle);
+
+	// Get multiple objects from the pool at once, honours the HandleEmptyPool option for the missing objects
+	static int32 AcquireFromPoolHolder(APoolHolder* PoolHolder, int32 Quantity, TArray<UObject*>& OutObjects, const FSpawnParameter& SpawnParameter);
+
+	bool IsPoolManagerReady() const;
 };
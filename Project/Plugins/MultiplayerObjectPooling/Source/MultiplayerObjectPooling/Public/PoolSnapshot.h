@@ -0,0 +1,63 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UnrealType.h"
+
+/**
+ * Remembers the values of all reset relevant properties of an object inside a compact byte blob.
+ * Only the properties which are declared by gameplay classes (C++ game modules and Blueprints) are captured,
+ * the engine properties are restored explicitly by the pool holder. Properties which reference the captured object itself
+ * or one of its subobjects (e.g. its components) are skipped, every pooled object has its own ones.
+ * The owner has to report the captured object references to the garbage collector with AddReferencedObjects.
+ */
+class FPoolPropertySnapshot
+{
+public:
+
+	FPoolPropertySnapshot() {}
+	FPoolPropertySnapshot(const FPoolPropertySnapshot& Other);
+	FPoolPropertySnapshot& operator=(const FPoolPropertySnapshot& Other);
+	~FPoolPropertySnapshot();
+
+	/*
+	* Capture the current property values of the object, its class is used to find the properties
+	* @param Object
+	* @param Owner	References to the owner or its subobjects are skipped as well, e.g. the actor of a captured component
+	*/
+	void Capture(const UObject* Object, const UObject* Owner = nullptr);
+
+	/*
+	* Copy the captured values back to the object, but only the properties which have diverged
+	* @return The number of properties which had to be restored
+	*/
+	int32 RestoreDirty(UObject* Object) const;
+
+	void Reset();
+
+	// Report the objects which are referenced by the captured values, the references to destroyed objects are cleared
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+	bool IsEmpty() const { return Properties.Num() == 0; }
+
+	int32 GetNumberOfProperties() const { return Properties.Num(); }
+
+	// Returns true for properties which should be captured
+	static bool IsResetRelevant(const UProperty* Property);
+
+private:
+
+	struct FCapturedProperty {
+		const UProperty* Property;
+		int32 Offset;
+		bool bHasObjectReferences;
+	};
+
+	TArray<FCapturedProperty> Properties;
+
+	// Contains the values of all captured properties, initialized by the properties themselves
+	TArray<uint8, TAlignedHeapAllocator<16>> Values;
+
+	void CopyFrom(const FPoolPropertySnapshot& Other);
+};
@@ -0,0 +1,65 @@
+// Copyright 2019 (C) Ramn Janousch
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_STATS_GROUP(TEXT("ObjectPool"), STATGROUP_ObjectPool, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Acquire"), STAT_PoolAcquire, STATGROUP_ObjectPool, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Release"), STAT_PoolRelease, STATGROUP_ObjectPool, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Restore"), STAT_PoolRestore, STATGROUP_ObjectPool, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Batched Update"), STAT_PoolBatchedUpdate, STATGROUP_ObjectPool, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Instance Flush"), STAT_PoolInstanceFlush, STATGROUP_ObjectPool, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Acquires"), STAT_PoolAcquires, STATGROUP_ObjectPool, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Releases"), STAT_PoolReleases, STATGROUP_ObjectPool, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Misses"), STAT_PoolMisses, STATGROUP_ObjectPool, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("On Demand Creations"), STAT_PoolOnDemandCreations, STATGROUP_ObjectPool, );
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Objects In Use"), STAT_PoolObjectsInUse, STATGROUP_ObjectPool, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Objects Available"), STAT_PoolObjectsAvailable, STATGROUP_ObjectPool, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Memory (KB)"), STAT_PoolMemory, STATGROUP_ObjectPool, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Instances Active"), STAT_PoolInstancesActive, STATGROUP_ObjectPool, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Instances Promoted"), STAT_PoolInstancesPromoted, STATGROUP_ObjectPool, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Buffer Blocks In Use"), STAT_PoolBufferBlocksInUse, STATGROUP_ObjectPool, );
+
+CSV_DECLARE_CATEGORY_EXTERN(ObjectPool);
+
+// Counters of a single pool, collected by the pool holder and the pool manager since the pool has been initialized
+struct FPoolStats
+{
+	// Number of requested objects
+	int32 Acquires = 0;
+
+	// Number of objects which went back to the pool
+	int32 Releases = 0;
+
+	// Number of requested objects which have been available inside the pool
+	int32 Hits = 0;
+
+	// Number of requested objects which weren't available, by the outcome of EHandleEmptyPool
+	int32 MissesIgnored = 0;
+	int32 MissesCreated = 0;
+	int32 MissesCreatedAndAdded = 0;
+	int32 MissesRecycled = 0;
+
+	// Number of objects which had to be created while an object was requested
+	int32 OnDemandCreations = 0;
+
+	int32 PeakInUse = 0;
+
+	// Accumulated time in cycles (FPlatformTime::Cycles64)
+	uint64 AcquireCycles = 0;
+	uint64 ReleaseCycles = 0;
+	uint64 RestoreCycles = 0;
+
+	int32 GetMisses() const { return MissesIgnored + MissesCreated + MissesCreatedAndAdded + MissesRecycled; }
+
+	// The average time in microseconds
+	static double GetAverageMicroseconds(uint64 Cycles, int32 Count) {
+		return Count > 0 ? FPlatformTime::ToMilliseconds64(Cycles) * 1000.0 / Count : 0.0;
+	}
+};
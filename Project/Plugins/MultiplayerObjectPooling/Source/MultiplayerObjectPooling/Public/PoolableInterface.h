@@ -34,4 +34,18 @@ public:
 	*/
 	UFUNCTION(BlueprintNativeEvent, Category = "Object Pool", Meta = (Tooltip = "Use this function instead of EndPlay"))
 		void PoolableEndPlay();
+
+	/*
+	* Gets called when the object is activated inside a pool with a batched update (only for native classes)
+	* @param Velocity				The initial velocity, zero by default
+	* @param RemainingLifeSpan	The initial life span, the life span of the pool by default
+	*/
+	virtual void PoolableBeginUpdate(FVector& Velocity, float& RemainingLifeSpan) {}
+
+	/*
+	* Gets called every frame by a pool with a batched update instead of the tick of the object (only for native classes).
+	* The pool moves the object by its velocity afterwards and returns it when its remaining life span runs out.
+	* Don't return the object to the pool from inside the update, set its remaining life span to zero instead
+	*/
+	virtual void PoolableUpdate(float DeltaSeconds, FVector& Location, FVector& Velocity, float& RemainingLifeSpan) {}
 };